@@ -0,0 +1,344 @@
+#include "buddy_memory_resource.h"
+#include "concurrent_fixed_memory_resource.h"
+#include "fixed_memory_resource.h"
+#include "growable_buffer.h"
+#include "mapped_memory_resource.h"
+#include "queue.h"
+#include "static_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Сравнение аллокаторов на двух нагрузках:
+// 1) очередь Queue<int> в установившемся режиме (push/pop узлов одного размера),
+//    здесь же пул слотов QueueNodePool и он же без виртуальных вызовов (QueueStaticPool)
+// 2) смешанная нагрузка: буферы-степени двойки вперемешку с узлами очереди
+// 3) очереди в нескольких потоках на одном пуле: мьютекс вокруг FixedMemoryResource
+//    против ConcurrentFixedMemoryResource с кэшами потоков
+// 4) пакеты по 10000 элементов: push по одному против push_range (allocate_bulk)
+// 5) данные переменной длины рядом с узлами очереди: рост с копированием (pmr::vector)
+//    против роста на месте (GrowableBuffer через try_expand)
+
+namespace {
+
+constexpr size_t kPoolSize = 16 * 1024 * 1024;
+
+// Детерминированный генератор, чтобы все аллокаторы получали одинаковую нагрузку
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) & 0x7fff;
+    }
+};
+
+struct Result {
+    double ns_per_op;
+    size_t failures;
+    double fragmentation;
+};
+
+template<typename Resource>
+Result run_queue(Resource& memory, size_t operations) {
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 1000; ++i) {
+        queue.push(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        queue.push(static_cast<int>(i));
+        queue.pop();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(2 * operations), 0, memory.get_fragmentation()};
+}
+
+// Та же нагрузка, но узлы выделяются из пула напрямую через StaticPoolAllocator
+template<typename Pool>
+Result run_static_queue(Pool& pool, size_t operations) {
+    StaticPoolQueue<int, Pool> queue(&pool);
+    for (int i = 0; i < 1000; ++i) {
+        queue.push(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        queue.push(static_cast<int>(i));
+        queue.pop();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(2 * operations), 0, 0.0};
+}
+
+// Пакет добавляется в очередь целиком, затем очередь обходится и очищается
+Result run_batches(FixedMemoryResource& memory, size_t operations, bool bulk) {
+    std::vector<int> batch(10000);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i] = static_cast<int>(i);
+    }
+    size_t rounds = std::max<size_t>(operations / batch.size(), 1);
+    Queue<int> queue(&memory);
+    long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        if (bulk) {
+            queue.push_range(batch.begin(), batch.end());
+        } else {
+            for (int value : batch) {
+                queue.push(value);
+            }
+        }
+        for (int value : queue) {
+            sum += value;
+        }
+        queue.clear();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    // Сумма нужна, чтобы компилятор не выбросил обход
+    volatile long long sink = sum;
+    (void)sink;
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(rounds * batch.size()), 0, memory.get_fragmentation()};
+}
+
+// Данные сообщения собираются кусками по 1 КБ, затем в очередь кладётся узел
+// pmr::vector растёт через новый блок и копирование, GrowableBuffer - на месте у вершины пула
+Result run_payloads(FixedMemoryResource& memory, size_t operations, bool in_place) {
+    constexpr size_t kPieces = 64;
+    char piece[1024] = {};
+    size_t rounds = std::max<size_t>(operations / kPieces, 1);
+    Queue<int> queue(&memory);
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        if (in_place) {
+            GrowableBuffer payload(memory);
+            for (size_t i = 0; i < kPieces; ++i) {
+                payload.append(piece, sizeof(piece));
+            }
+            total += payload.size();
+        } else {
+            std::pmr::vector<char> payload(&memory);
+            for (size_t i = 0; i < kPieces; ++i) {
+                payload.insert(payload.end(), piece, piece + sizeof(piece));
+            }
+            total += payload.size();
+        }
+        queue.push(static_cast<int>(round));
+        if (queue.size() > 100) {
+            queue.pop();
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    volatile size_t sink = total;
+    (void)sink;
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(rounds * kPieces), 0, memory.get_fragmentation()};
+}
+
+template<typename Resource>
+Result run_mixed(Resource& memory, size_t operations) {
+    Random random{42};
+    std::vector<std::pair<void*, size_t>> live;
+    live.reserve(4096);
+    size_t failures = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        if (live.size() < 4000 && (live.empty() || random.next() % 2 == 0)) {
+            // Каждый четвёртый запрос - буфер 64..4096 байт, остальные - узлы по 16 байт
+            size_t bytes = random.next() % 4 == 0 ? size_t{64} << (random.next() % 7) : 16;
+            try {
+                live.emplace_back(memory.allocate(bytes), bytes);
+            } catch (const std::bad_alloc&) {
+                ++failures;
+            }
+        } else {
+            size_t index = random.next() % live.size();
+            memory.deallocate(live[index].first, live[index].second);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double fragmentation = memory.get_fragmentation();
+    for (auto& [ptr, bytes] : live) {
+        memory.deallocate(ptr, bytes);
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(operations), failures, fragmentation};
+}
+
+// FixedMemoryResource целиком под одним мьютексом - базовая линия для многопоточной нагрузки
+class LockedFixedMemoryResource : public std::pmr::memory_resource {
+private:
+    FixedMemoryResource memory_;
+    mutable std::mutex mutex_;
+
+public:
+    explicit LockedFixedMemoryResource(size_t size) : memory_(size) {}
+
+    double get_fragmentation() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return memory_.get_fragmentation();
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return memory_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        memory_.deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Каждый поток гоняет свою очередь, время - от старта первого до завершения последнего
+template<typename Resource>
+Result run_threads(Resource& memory, size_t operations, size_t thread_count) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&memory, operations] {
+            Queue<int> queue(&memory);
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(i);
+            }
+            for (size_t i = 0; i < operations; ++i) {
+                queue.push(static_cast<int>(i));
+                queue.pop();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+    return {ns / static_cast<double>(2 * operations * thread_count), 0, memory.get_fragmentation()};
+}
+
+void print_row(const std::string& name, const Result& result) {
+    std::cout << "  " << std::left << std::setw(24) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << result.ns_per_op << " нс/оп"
+              << std::setw(10) << result.failures << " отказов"
+              << std::setw(10) << std::setprecision(3) << result.fragmentation << " фрагм.\n";
+}
+
+template<typename Benchmark>
+void run_all(const std::string& title, Benchmark benchmark) {
+    std::cout << title << "\n";
+    {
+        FixedMemoryResource memory(kPoolSize, AllocationStrategy::SegregatedFit);
+        print_row("Fixed/SegregatedFit", benchmark(memory));
+    }
+    {
+        FixedMemoryResource memory(kPoolSize, AllocationStrategy::Tlsf);
+        print_row("Fixed/Tlsf", benchmark(memory));
+    }
+    {
+        // Пул из mmap с большими страницами, заполненный заранее: без page fault на горячем пути
+        MappedMemoryResource mapped({HugePages::Transparent, true, false});
+        FixedMemoryResourceOptions options;
+        options.initial_size = kPoolSize;
+        options.upstream = &mapped;
+        options.max_total_size = kPoolSize;
+        FixedMemoryResource memory(options);
+        print_row("Fixed/mmap+THP+populate", benchmark(memory));
+    }
+    {
+        BuddyMemoryResource memory(kPoolSize);
+        print_row("Buddy", benchmark(memory));
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t operations = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    run_all("Очередь Queue<int>, push+pop:", [operations](auto& memory) {
+        return run_queue(memory, operations);
+    });
+    {
+        // Пул слотов подходит только для узлов одного размера
+        QueueNodePool<int> memory(kPoolSize);
+        print_row("Slab/QueueNodePool", run_queue(memory, operations));
+    }
+    {
+        QueueStaticPool<int> pool(kPoolSize);
+        print_row("Slab/QueueStaticPool", run_static_queue(pool, operations));
+    }
+    std::cout << "\n";
+
+    run_all("Смешанная нагрузка (узлы + буферы 2^k):", [operations](auto& memory) {
+        return run_mixed(memory, operations);
+    });
+    std::cout << "\n";
+
+    size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "Очереди Queue<int> в " << thread_count << " потоках, push+pop:\n";
+    {
+        LockedFixedMemoryResource memory(kPoolSize);
+        print_row("Fixed + mutex", run_threads(memory, operations / thread_count, thread_count));
+    }
+    {
+        ConcurrentFixedMemoryResource memory(kPoolSize);
+        print_row("Concurrent", run_threads(memory, operations / thread_count, thread_count));
+    }
+    std::cout << "\n";
+
+    std::cout << "Пакеты по 10000 элементов Queue<int>, добавление + обход + очистка (на элемент):\n";
+    {
+        FixedMemoryResource memory(kPoolSize);
+        print_row("Fixed/push", run_batches(memory, operations, false));
+    }
+    {
+        FixedMemoryResource memory(kPoolSize);
+        print_row("Fixed/push_range", run_batches(memory, operations, true));
+    }
+    std::cout << "\n";
+
+    std::cout << "Данные сообщений по 64 куска в 1 КБ (на дописывание куска):\n";
+    {
+        FixedMemoryResource memory(kPoolSize);
+        print_row("Fixed/pmr::vector", run_payloads(memory, operations, false));
+    }
+    {
+        FixedMemoryResource memory(kPoolSize);
+        print_row("Fixed/GrowableBuffer", run_payloads(memory, operations, true));
+    }
+    std::cout << "\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "allocation_trace.h"
+#include "fixed_memory_resource.h"
+#include "queue.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Воспроизведение трассы выделений на разных аллокаторах
+// Использование: lab05_trace_replay [файл трассы]
+// Трасса пишется через FixedMemoryResource::set_trace_recorder и TraceRecorder::open
+// Без аргумента записывается и воспроизводится встроенная нагрузка (очереди и буферы)
+//
+// Пиковый объём - максимум памяти, взятой у системы (у upstream ресурса),
+// фрагментация - доля этого объёма сверх пика запрошенных байт
+
+namespace {
+
+// Upstream, который считает взятую память и её максимум
+class FootprintResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream_;
+    size_t current_;
+    size_t peak_;
+
+public:
+    explicit FootprintResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), current_(0), peak_(0) {}
+
+    size_t get_peak() const { return peak_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* ptr = upstream_->allocate(bytes, alignment);
+        current_ += bytes;
+        peak_ = std::max(peak_, current_);
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(ptr, bytes, alignment);
+        current_ -= bytes;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Встроенная нагрузка: очереди узлов вперемешку с буферами разных размеров
+std::vector<TraceEvent> record_builtin_trace() {
+    TraceRecorder recorder(size_t{1} << 20);
+    FixedMemoryResourceOptions options;
+    options.initial_size = 64 * 1024;
+    options.upstream = std::pmr::new_delete_resource();
+    FixedMemoryResource memory(options);
+    memory.set_trace_recorder(&recorder);
+
+    Queue<int> small(&memory);
+    Queue<std::string> strings(&memory);
+    std::vector<std::pair<void*, size_t>> buffers;
+    uint32_t state = 42;
+    for (int i = 0; i < 200000; ++i) {
+        state = state * 1103515245 + 12345;
+        uint32_t random = (state >> 16) & 0x7fff;
+        small.push(i);
+        if (random % 3 == 0) {
+            small.pop();
+        }
+        if (random % 5 == 0) {
+            strings.push(std::string(16 + random % 64, 'x'));
+        }
+        if (random % 7 == 0 && !strings.empty()) {
+            strings.pop();
+        }
+        if (random % 11 == 0) {
+            size_t bytes = size_t{64} << (random % 8);
+            buffers.emplace_back(memory.allocate(bytes), bytes);
+        }
+        if (random % 13 == 0 && !buffers.empty()) {
+            size_t index = random % buffers.size();
+            memory.deallocate(buffers[index].first, buffers[index].second);
+            buffers[index] = buffers.back();
+            buffers.pop_back();
+        }
+    }
+    for (auto& [ptr, bytes] : buffers) {
+        memory.deallocate(ptr, bytes);
+    }
+    small.clear();
+    strings.clear();
+
+    memory.set_trace_recorder(nullptr);
+    return recorder.get_events();
+}
+
+void print_row(const std::string& name, const TraceReplayResult& result, size_t footprint) {
+    double fragmentation = footprint == 0
+        ? 0.0
+        : 1.0 - static_cast<double>(result.peak_live_bytes) / static_cast<double>(footprint);
+    std::cout << "  " << std::left << std::setw(24) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << static_cast<double>(result.operations) / result.seconds / 1e6 << " Моп/с"
+              << std::setw(12) << footprint / 1024 << " КБ пик"
+              << std::setw(10) << std::setprecision(3) << std::max(fragmentation, 0.0) << " фрагм."
+              << std::setw(8) << result.failures << " отказов\n";
+}
+
+// Растущий пул: участки берутся у upstream по мере надобности, поэтому пиковый объём виден
+void replay_fixed(const TraceReplay& replay, const std::string& name, AllocationStrategy strategy) {
+    FootprintResource upstream;
+    FixedMemoryResourceOptions options;
+    options.initial_size = 64 * 1024;
+    options.strategy = strategy;
+    options.upstream = &upstream;
+    FixedMemoryResource memory(options);
+    TraceReplayResult result = replay.run(memory);
+    print_row(name, result, upstream.get_peak());
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<TraceEvent> events;
+    try {
+        events = argc > 1 ? TraceRecorder::load(argv[1]) : record_builtin_trace();
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    TraceReplay replay(events);
+    std::cout << "Трасса: " << events.size() << " событий, "
+              << replay.get_operation_count() << " операций, до "
+              << replay.get_slot_count() << " блоков одновременно\n";
+
+    replay_fixed(replay, "Fixed/SegregatedFit", AllocationStrategy::SegregatedFit);
+    replay_fixed(replay, "Fixed/Tlsf", AllocationStrategy::Tlsf);
+    {
+        FootprintResource upstream;
+        std::pmr::unsynchronized_pool_resource memory(&upstream);
+        TraceReplayResult result = replay.run(memory);
+        print_row("unsynchronized_pool", result, upstream.get_peak());
+    }
+    {
+        // Накладные расходы malloc не видны: пиковый объём - это пик запрошенных байт
+        FootprintResource memory;
+        TraceReplayResult result = replay.run(memory);
+        print_row("new_delete", result, memory.get_peak());
+    }
+    return 0;
+}
\ No newline at end of file
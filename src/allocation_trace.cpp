@@ -0,0 +1,283 @@
+#include "allocation_trace.h"
+#include "bit_utils.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Заголовок файла трассы
+struct TraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t event_size;
+};
+
+constexpr char kTraceMagic[8] = {'L', 'A', 'B', '5', 'T', 'R', 'C', '\0'};
+constexpr uint32_t kTraceVersion = 1;
+
+TraceFileHeader make_header() {
+    TraceFileHeader header;
+    std::memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    header.version = kTraceVersion;
+    header.event_size = sizeof(TraceEvent);
+    return header;
+}
+
+// Выравнивание при воспроизведении хранится в uint32_t
+constexpr uint8_t kMaxAlignmentLog2 = 31;
+
+// Событие могло быть записано только TraceRecorder: известная операция и выравнивание
+bool is_valid_event(const TraceEvent& event) {
+    bool known_op = event.op == TraceOp::Allocate || event.op == TraceOp::Deallocate ||
+                    event.op == TraceOp::Release || event.op == TraceOp::Rollback;
+    return known_op && event.alignment_log2 <= kMaxAlignmentLog2;
+}
+
+}
+
+TraceRecorder::TraceRecorder(size_t capacity)
+    : buffer_(size_t{1} << (floor_log2(std::max<size_t>(capacity, 2) - 1) + 1)),
+      mask_(buffer_.size() - 1), head_(0), tail_(0), dropped_(0) {}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+void TraceRecorder::open(const std::string& path) {
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        throw std::runtime_error("Cannot open trace file " + path);
+    }
+    TraceFileHeader header = make_header();
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void TraceRecorder::close() {
+    if (file_.is_open()) {
+        flush();
+        file_.close();
+    }
+}
+
+// Буфер кольцевой, поэтому накопленные события лежат не более чем двумя кусками
+void TraceRecorder::flush() {
+    if (!file_.is_open()) {
+        return;
+    }
+    while (tail_ != head_) {
+        size_t start = tail_ & mask_;
+        size_t count = std::min(head_ - tail_, buffer_.size() - start);
+        file_.write(reinterpret_cast<const char*>(&buffer_[start]),
+                    static_cast<std::streamsize>(count * sizeof(TraceEvent)));
+        tail_ += count;
+    }
+    file_.flush();
+}
+
+// Событие пишется в ячейку head_; при полном буфере он сбрасывается в файл
+// или освобождает место, вытесняя самое старое событие
+void TraceRecorder::record(TraceOp op, size_t size, size_t alignment, const void* ptr, size_t marker_depth) {
+    if (head_ - tail_ == buffer_.size()) {
+        if (file_.is_open()) {
+            flush();
+        } else {
+            ++tail_;
+            ++dropped_;
+        }
+    }
+
+    TraceEvent& event = buffer_[head_ & mask_];
+    event.timestamp = read_cycle_counter();
+    event.address = reinterpret_cast<uintptr_t>(ptr);
+    event.size = static_cast<uint32_t>(std::min<size_t>(size, std::numeric_limits<uint32_t>::max()));
+    event.op = op;
+    event.alignment_log2 = alignment == 0 ? 0 : static_cast<uint8_t>(lowest_bit(alignment));
+    event.marker_depth = static_cast<uint16_t>(marker_depth);
+    ++head_;
+}
+
+std::vector<TraceEvent> TraceRecorder::get_events() const {
+    std::vector<TraceEvent> events;
+    events.reserve(head_ - tail_);
+    for (size_t index = tail_; index != head_; ++index) {
+        events.push_back(buffer_[index & mask_]);
+    }
+    return events;
+}
+
+void TraceRecorder::save(const std::string& path, const std::vector<TraceEvent>& events) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    TraceFileHeader header = make_header();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(events.data()),
+               static_cast<std::streamsize>(events.size() * sizeof(TraceEvent)));
+    if (!file) {
+        throw std::runtime_error("Cannot write trace file " + path);
+    }
+}
+
+std::vector<TraceEvent> TraceRecorder::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open trace file " + path);
+    }
+
+    TraceFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0 ||
+        header.version != kTraceVersion || header.event_size != sizeof(TraceEvent)) {
+        throw std::runtime_error("Not an allocation trace: " + path);
+    }
+
+    // Недописанное последнее событие (запись прервалась) отбрасывается
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    while (file.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+        if (!is_valid_event(event)) {
+            throw std::runtime_error("Corrupted allocation trace: " + path);
+        }
+        events.push_back(event);
+    }
+    return events;
+}
+
+// Адрес живого блока отображается в номер ячейки, освободившиеся ячейки используются повторно
+TraceReplay::TraceReplay(const std::vector<TraceEvent>& events) : slot_count_(0) {
+    struct LiveBlock {
+        uint32_t slot;
+        uint16_t marker_depth;
+    };
+    std::unordered_map<uint64_t, LiveBlock> live;
+    std::vector<uint32_t> free_slots;
+    operations_.reserve(events.size());
+
+    auto release_slot = [&](uint32_t slot) {
+        operations_.push_back({TraceOp::Deallocate, 0, 0, slot});
+        free_slots.push_back(slot);
+    };
+
+    for (const TraceEvent& event : events) {
+        if (!is_valid_event(event)) {
+            throw std::invalid_argument("Invalid trace event");
+        }
+        switch (event.op) {
+        case TraceOp::Allocate: {
+            // Адрес ещё занят: освобождение прежнего блока не попало в трассу
+            auto it = live.find(event.address);
+            if (it != live.end()) {
+                release_slot(it->second.slot);
+                live.erase(it);
+            }
+            uint32_t slot;
+            if (!free_slots.empty()) {
+                slot = free_slots.back();
+                free_slots.pop_back();
+            } else {
+                slot = static_cast<uint32_t>(slot_count_++);
+            }
+            live[event.address] = {slot, event.marker_depth};
+            operations_.push_back({TraceOp::Allocate, event.size,
+                                   uint32_t{1} << event.alignment_log2, slot});
+            break;
+        }
+        case TraceOp::Deallocate: {
+            auto it = live.find(event.address);
+            if (it == live.end()) {
+                break;
+            }
+            operations_.push_back({TraceOp::Deallocate, event.size,
+                                   uint32_t{1} << event.alignment_log2, it->second.slot});
+            free_slots.push_back(it->second.slot);
+            live.erase(it);
+            break;
+        }
+        case TraceOp::Release:
+            operations_.push_back({TraceOp::Release, 0, 0, 0});
+            for (auto& [address, block] : live) {
+                free_slots.push_back(block.slot);
+            }
+            live.clear();
+            break;
+        case TraceOp::Rollback:
+            for (auto it = live.begin(); it != live.end();) {
+                if (it->second.marker_depth > event.marker_depth) {
+                    release_slot(it->second.slot);
+                    it = live.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            break;
+        }
+    }
+}
+
+TraceReplayResult TraceReplay::run(std::pmr::memory_resource& resource) const {
+    struct Slot {
+        void* ptr;
+        uint32_t size;
+        uint32_t alignment;
+    };
+    std::vector<Slot> slots(slot_count_, Slot{nullptr, 0, 0});
+
+    TraceReplayResult result{0, 0.0, 0, 0};
+    size_t live_bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Operation& operation : operations_) {
+        switch (operation.op) {
+        case TraceOp::Allocate:
+            try {
+                slots[operation.slot] = {resource.allocate(operation.size, operation.alignment),
+                                         operation.size, operation.alignment};
+                live_bytes += operation.size;
+                result.peak_live_bytes = std::max(result.peak_live_bytes, live_bytes);
+            } catch (const std::bad_alloc&) {
+                slots[operation.slot].ptr = nullptr;
+                ++result.failures;
+            }
+            ++result.operations;
+            break;
+        case TraceOp::Deallocate: {
+            Slot& slot = slots[operation.slot];
+            if (slot.ptr) {
+                resource.deallocate(slot.ptr, slot.size, slot.alignment);
+                live_bytes -= slot.size;
+                slot.ptr = nullptr;
+                ++result.operations;
+            }
+            break;
+        }
+        case TraceOp::Release:
+            // Ресурс не обязан уметь сбрасываться целиком, поэтому блоки освобождаются по одному
+            for (Slot& slot : slots) {
+                if (slot.ptr) {
+                    resource.deallocate(slot.ptr, slot.size, slot.alignment);
+                    slot.ptr = nullptr;
+                    ++result.operations;
+                }
+            }
+            live_bytes = 0;
+            break;
+        case TraceOp::Rollback:
+            // Не встречается: откат разворачивается в освобождения при подготовке
+            break;
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(finish - start).count();
+
+    for (Slot& slot : slots) {
+        if (slot.ptr) {
+            resource.deallocate(slot.ptr, slot.size, slot.alignment);
+        }
+    }
+    return result;
+}
\ No newline at end of file
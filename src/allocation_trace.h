@@ -0,0 +1,126 @@
+#ifndef ALLOCATION_TRACE_H
+#define ALLOCATION_TRACE_H
+
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Операция в трассе выделений
+enum class TraceOp : uint8_t {
+    Allocate,
+    Deallocate,
+    // Сброс пула целиком (FixedMemoryResource::release): все блоки освобождены
+    Release,
+    // Откат к метке (FixedMemoryResource::rollback): освобождены все блоки,
+    // выделенные глубже marker_depth
+    Rollback
+};
+
+// Событие трассы, в файле хранится как есть (24 байта)
+struct TraceEvent {
+    uint64_t timestamp;     // счётчик тактов (read_cycle_counter)
+    uint64_t address;       // адрес блока, по нему выделение связывается с освобождением
+    uint32_t size;          // запрошенный размер (больше 4 ГБ не бывает, обрезается)
+    TraceOp op;
+    uint8_t alignment_log2;
+    uint16_t marker_depth;  // Allocate - число активных меток при выделении, Rollback - после отката
+};
+
+static_assert(sizeof(TraceEvent) == 24, "TraceEvent is written to files as is");
+
+// Запись трассы выделений в кольцевой буфер
+// Буфер заполняется на горячем пути без выделений памяти и системных вызовов
+// Если открыт файл, заполненный буфер целиком дописывается в него (поток событий без потерь),
+// иначе новые события вытесняют самые старые - в буфере остаются последние capacity событий
+// Пишет один поток: владелец ресурса, к которому подключена запись
+class TraceRecorder {
+private:
+    std::vector<TraceEvent> buffer_;
+    size_t mask_;
+
+    // Номер следующего события и номер первого ещё не записанного в файл (не вытесненного)
+    size_t head_;
+    size_t tail_;
+
+    size_t dropped_;
+    std::ofstream file_;
+
+public:
+    // Ёмкость буфера округляется вверх до степени двойки
+    explicit TraceRecorder(size_t capacity = 65536);
+
+    // Деструктор дописывает буфер в открытый файл
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Открытие файла трассы: пишется заголовок, дальше события дописываются по мере заполнения буфера
+    // Выбрасывает std::runtime_error, если файл не открылся
+    void open(const std::string& path);
+
+    // Запись буфера в файл и закрытие файла
+    void close();
+
+    // Запись накопленных событий в открытый файл
+    void flush();
+
+    // Учёт одного события
+    void record(TraceOp op, size_t size, size_t alignment, const void* ptr, size_t marker_depth = 0);
+
+    // События в буфере (ещё не записанные в файл), от старых к новым
+    std::vector<TraceEvent> get_events() const;
+
+    // Всего записано событий и сколько из них вытеснено без записи в файл
+    size_t get_recorded_count() const { return head_; }
+    size_t get_dropped_count() const { return dropped_; }
+
+    // Сохранение и загрузка трассы целиком
+    // Выбрасывают std::runtime_error при ошибке ввода-вывода или неверном формате
+    // (в том числе при событии с неизвестной операцией или выравниванием больше 2^31)
+    static void save(const std::string& path, const std::vector<TraceEvent>& events);
+    static std::vector<TraceEvent> load(const std::string& path);
+};
+
+// Результат воспроизведения трассы
+struct TraceReplayResult {
+    size_t operations;          // выполнено allocate + deallocate
+    double seconds;             // время воспроизведения
+    size_t peak_live_bytes;     // максимум запрошенных байт в занятых блоках
+    size_t failures;            // выделения, закончившиеся std::bad_alloc
+};
+
+// Трасса, подготовленная к воспроизведению на любом std::pmr::memory_resource
+// Адреса заменяются номерами ячеек, поэтому во время прогона нет поиска по адресам
+// Освобождения блоков, выделенных до начала записи, отбрасываются
+// Откат к метке превращается в освобождение блоков, выделенных после неё,
+// повторное выделение ещё занятого адреса - в освобождение прежнего блока
+class TraceReplay {
+private:
+    struct Operation {
+        TraceOp op;
+        uint32_t size;
+        uint32_t alignment;
+        uint32_t slot;
+    };
+
+    std::vector<Operation> operations_;
+
+    // Сколько блоков живёт одновременно (размер таблицы указателей при прогоне)
+    size_t slot_count_;
+
+public:
+    // Выбрасывает std::invalid_argument при событии, которое не мог записать TraceRecorder
+    explicit TraceReplay(const std::vector<TraceEvent>& events);
+
+    // Прогон трассы; блоки, оставшиеся занятыми в конце трассы, освобождаются после замера
+    TraceReplayResult run(std::pmr::memory_resource& resource) const;
+
+    size_t get_operation_count() const { return operations_.size(); }
+    size_t get_slot_count() const { return slot_count_; }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef BIT_UTILS_H
+#define BIT_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Вспомогательные битовые операции для аллокаторов
+// Подключается только из .cpp файлов библиотеки
+
+// Округление value вверх до ближайшего кратного alignment (степень двойки)
+inline size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Номер старшего установленного бита (value != 0)
+inline size_t floor_log2(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<size_t>(__builtin_clzll(value));
+#else
+    size_t result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+// Номер младшего установленного бита (value != 0)
+inline size_t lowest_bit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(value));
+#else
+    size_t result = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+#endif
\ No newline at end of file
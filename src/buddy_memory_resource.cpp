@@ -0,0 +1,247 @@
+#include "buddy_memory_resource.h"
+#include "bit_utils.h"
+#include "fixed_memory_resource.h" // FIXED_MEMORY_RESOURCE_CHECKED
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+
+// Конструктор: выделяет пул и раскладывает его на максимальные блоки-степени двойки
+BuddyMemoryResource::BuddyMemoryResource(size_t size)
+    : pool_size_(size), usable_size_(0), max_order_(0), free_lists_bitmap_(0),
+      state_bitmap_(nullptr), allocated_base_(0), allocated_count_(0), allocated_bytes_(0), requested_bytes_(0) {
+
+    std::fill(std::begin(free_lists_), std::end(free_lists_), nullptr);
+    std::fill(std::begin(state_offsets_), std::end(state_offsets_), 0);
+
+    // Пул выровнен на страницу, чтобы выравнивание блоков по смещению
+    // совпадало с выравниванием по абсолютному адресу
+    memory_pool_ = ::operator new(pool_size_, std::align_val_t{kPoolAlignment});
+    char* base = static_cast<char*>(memory_pool_);
+
+    // Битовые карты занимают конец пула: для порядка k нужно size >> k бит в каждой
+    size_t top_order = (size >> kMinOrder) != 0 ? std::min(floor_log2(size), kMaxOrders - 1) : 0;
+    size_t words = 0;
+    for (size_t order = kMinOrder; order <= top_order; ++order) {
+        state_offsets_[order] = words * 64;
+        words += ((size >> order) + 64) / 64;
+    }
+    allocated_base_ = words * 64;
+    size_t bitmap_bytes = 2 * words * sizeof(uint64_t);
+    if (bitmap_bytes >= size) {
+        return;
+    }
+
+    // Блоки занимают начало пула, карта лежит сразу за ними
+    usable_size_ = (size - bitmap_bytes) & ~((size_t{1} << kMinOrder) - 1);
+    state_bitmap_ = reinterpret_cast<uint64_t*>(base + usable_size_);
+    std::memset(state_bitmap_, 0, bitmap_bytes);
+    if (usable_size_ == 0) {
+        return;
+    }
+
+    // Раскладываем пул на блоки убывающих порядков (по двоичной записи размера)
+    // Каждый такой блок выровнен на свой размер, а его двойник лежит за пределами пула,
+    // поэтому слияния никогда не выходят за границы исходной раскладки
+    max_order_ = floor_log2(usable_size_);
+    size_t offset = 0;
+    for (size_t order = max_order_ + 1; order-- > kMinOrder;) {
+        if (usable_size_ - offset >= (size_t{1} << order)) {
+            push_free_block(order, offset);
+            offset += size_t{1} << order;
+        }
+    }
+}
+
+// Деструктор: освобождает весь блок памяти
+BuddyMemoryResource::~BuddyMemoryResource() {
+    if (allocated_count_ != 0) {
+        std::cout << "Внимание: освобождается память с "
+                  << allocated_count_ << " неосвобождёнными блоками\n";
+    }
+    ::operator delete(memory_pool_, std::align_val_t{kPoolAlignment});
+}
+
+// Выделение: берём наименьший свободный блок не меньше нужного порядка
+// и делим его пополам, пока он не станет нужного размера
+void* BuddyMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    size_t order = order_for(bytes, alignment);
+    if (alignment > kPoolAlignment || order > max_order_) {
+        throw std::bad_alloc();
+    }
+
+    uint64_t candidates = free_lists_bitmap_ & (~uint64_t{0} << order);
+    if (candidates == 0) {
+        throw std::bad_alloc();
+    }
+
+    size_t current = lowest_bit(candidates);
+    char* base = static_cast<char*>(memory_pool_);
+    size_t offset = static_cast<size_t>(reinterpret_cast<char*>(free_lists_[current]) - base);
+    remove_free_block(current, offset);
+
+    // Правые половинки при делении становятся свободными блоками меньших порядков
+    while (current > order) {
+        --current;
+        push_free_block(current, offset + (size_t{1} << current));
+    }
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    set_allocated_bit(order, offset, true);
+#endif
+    ++allocated_count_;
+    allocated_bytes_ += size_t{1} << order;
+    requested_bytes_ += bytes;
+    return base + offset;
+}
+
+// Освобождение: блок сливается с двойником, пока тот свободен
+void BuddyMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    char* base = static_cast<char*>(memory_pool_);
+    char* p = static_cast<char*>(ptr);
+    size_t order = order_for(bytes, alignment);
+    size_t offset = static_cast<size_t>(p - base);
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    // Блок должен лежать в пуле, быть выровнен на свой размер и быть выделен именно этого порядка
+    // Бит свободного блока для этого не годится: после слияния с двойником свободен родитель,
+    // а бит самого блока сброшен
+    if (p < base || p >= base + usable_size_ || order > max_order_ ||
+        offset % (size_t{1} << order) != 0) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+    if (!is_allocated(order, offset)) {
+        // Начало блока, который уже освобождён, или указатель/размер, не совпадающий с выделением
+        bool freed = false;
+        for (size_t ancestor = order; ancestor <= max_order_ && !freed; ++ancestor) {
+            freed = is_free(ancestor, offset & ~((size_t{1} << ancestor) - 1));
+        }
+        throw std::invalid_argument(freed ? "Block is already free" : "Block not allocated by this resource");
+    }
+    set_allocated_bit(order, offset, false);
+#endif
+
+    --allocated_count_;
+    allocated_bytes_ -= size_t{1} << order;
+    requested_bytes_ -= bytes;
+
+    while (order < max_order_) {
+        size_t buddy = offset ^ (size_t{1} << order);
+        if (buddy + (size_t{1} << order) > usable_size_ || !is_free(order, buddy)) {
+            break;
+        }
+        remove_free_block(order, buddy);
+        offset &= ~(size_t{1} << order);
+        ++order;
+    }
+    push_free_block(order, offset);
+}
+
+// Сравнение memory_resource
+bool BuddyMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// Вывод статистики
+void BuddyMemoryResource::print_stats() const {
+    std::cout << "\nСтатистика использования памяти (buddy):\n"
+              << "Общий размер: " << pool_size_ << " байт\n"
+              << "Размер под блоки: " << usable_size_ << " байт\n"
+              << "Занято в блоках: " << allocated_bytes_ << " байт\n"
+              << "Активных блоков: " << allocated_count_ << "\n"
+              << "Наибольший свободный блок: " << get_largest_free_block() << " байт\n"
+              << "Внутренняя фрагментация: " << get_internal_fragmentation() << " байт\n\n";
+}
+
+size_t BuddyMemoryResource::get_largest_free_block() const {
+    if (free_lists_bitmap_ == 0) {
+        return 0;
+    }
+    return size_t{1} << floor_log2(free_lists_bitmap_);
+}
+
+double BuddyMemoryResource::get_fragmentation() const {
+    size_t free_bytes = get_free_bytes();
+    if (free_bytes == 0) {
+        return 0.0;
+    }
+    return 1.0 - static_cast<double>(get_largest_free_block()) / static_cast<double>(free_bytes);
+}
+
+size_t BuddyMemoryResource::get_free_count(size_t order) const {
+    size_t count = 0;
+    if (order < kMaxOrders) {
+        for (const FreeNode* node = free_lists_[order]; node; node = node->next) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Порядок: наименьшая степень двойки, вмещающая и размер, и выравнивание
+size_t BuddyMemoryResource::order_for(size_t bytes, size_t alignment) const {
+    size_t need = std::max({bytes, alignment, size_t{1} << kMinOrder});
+    return floor_log2(need - 1) + 1;
+}
+
+void BuddyMemoryResource::push_free_block(size_t order, size_t offset) {
+    auto* node = reinterpret_cast<FreeNode*>(static_cast<char*>(memory_pool_) + offset);
+    node->prev = nullptr;
+    node->next = free_lists_[order];
+    if (node->next) {
+        node->next->prev = node;
+    }
+    free_lists_[order] = node;
+    free_lists_bitmap_ |= uint64_t{1} << order;
+    set_free_bit(order, offset, true);
+}
+
+void BuddyMemoryResource::remove_free_block(size_t order, size_t offset) {
+    auto* node = reinterpret_cast<FreeNode*>(static_cast<char*>(memory_pool_) + offset);
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        free_lists_[order] = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    if (!free_lists_[order]) {
+        free_lists_bitmap_ &= ~(uint64_t{1} << order);
+    }
+    set_free_bit(order, offset, false);
+}
+
+bool BuddyMemoryResource::is_free(size_t order, size_t offset) const {
+    return test_bit(state_bit(order, offset));
+}
+
+void BuddyMemoryResource::set_free_bit(size_t order, size_t offset, bool value) {
+    assign_bit(state_bit(order, offset), value);
+}
+
+bool BuddyMemoryResource::is_allocated(size_t order, size_t offset) const {
+    return test_bit(allocated_base_ + state_bit(order, offset));
+}
+
+void BuddyMemoryResource::set_allocated_bit(size_t order, size_t offset, bool value) {
+    assign_bit(allocated_base_ + state_bit(order, offset), value);
+}
+
+size_t BuddyMemoryResource::state_bit(size_t order, size_t offset) const {
+    return state_offsets_[order] + (offset >> order);
+}
+
+bool BuddyMemoryResource::test_bit(size_t bit) const {
+    return (state_bitmap_[bit / 64] >> (bit % 64)) & 1;
+}
+
+void BuddyMemoryResource::assign_bit(size_t bit, bool value) {
+    if (value) {
+        state_bitmap_[bit / 64] |= uint64_t{1} << (bit % 64);
+    } else {
+        state_bitmap_[bit / 64] &= ~(uint64_t{1} << (bit % 64));
+    }
+}
\ No newline at end of file
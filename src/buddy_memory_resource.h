@@ -0,0 +1,114 @@
+#ifndef BUDDY_MEMORY_RESOURCE_H
+#define BUDDY_MEMORY_RESOURCE_H
+
+#include <memory_resource>
+#include <cstddef>
+#include <cstdint>
+
+// Аллокатор системы двойников (buddy system) поверх одного фиксированного блока памяти
+// Пул делится на блоки размером 2^order, при выделении большой блок делится пополам,
+// при освобождении блок сливается со своим "двойником", если тот свободен
+// Размер блока однозначно определяется по bytes/alignment, поэтому заголовки не нужны
+class BuddyMemoryResource : public std::pmr::memory_resource {
+private:
+    // Минимальный блок 16 байт: в нём помещается узел списка свободных
+    static constexpr size_t kMinOrder = 4;
+    static constexpr size_t kMaxOrders = 48;
+
+    // Пул выравнивается на страницу, поэтому блок порядка k <= 12
+    // выровнен по абсолютному адресу на 2^k
+    static constexpr size_t kPoolAlignment = 4096;
+
+    // Узел интрусивного двусвязного списка свободных блоков одного порядка
+    struct FreeNode {
+        FreeNode* next;
+        FreeNode* prev;
+    };
+
+    // Указатель на начало фиксированного блока памяти
+    void* memory_pool_;
+
+    // Общий размер блока памяти в байтах
+    size_t pool_size_;
+
+    // Часть пула, которая делится на блоки (в конце пула лежит битовая карта)
+    size_t usable_size_;
+
+    // Наибольший порядок блока, помещающегося в пул
+    size_t max_order_;
+
+    // Списки свободных блоков по порядкам и битовая карта непустых списков
+    FreeNode* free_lists_[kMaxOrders];
+    uint64_t free_lists_bitmap_;
+
+    // Битовая карта состояний: для каждого порядка k по биту на каждый блок 2^k,
+    // бит установлен, если блок свободен и лежит в списке порядка k
+    // По ней за O(1) проверяется, свободен ли двойник освобождаемого блока
+    uint64_t* state_bitmap_;
+    size_t state_offsets_[kMaxOrders];
+
+    // Вторая карта той же раскладки (начинается с бита allocated_base_):
+    // бит установлен, если блок выделен целиком как блок порядка k
+    // Ведётся только с проверками: по ней отсекаются повторное освобождение
+    // (в том числе после слияния с двойником), указатели внутрь блока и чужой размер
+    size_t allocated_base_;
+
+    // Статистика
+    size_t allocated_count_;
+    size_t allocated_bytes_;
+    size_t requested_bytes_;
+
+public:
+    // Конструктор: выделяет фиксированный блок памяти заданного размера
+    // size - размер блока в байтах (по умолчанию 1 МБ)
+    explicit BuddyMemoryResource(size_t size = 1024 * 1024);
+
+    // Деструктор: освобождает весь блок памяти
+    ~BuddyMemoryResource() override;
+
+    // Ресурс уникален: копирование и перемещение запрещены
+    BuddyMemoryResource(const BuddyMemoryResource&) = delete;
+    BuddyMemoryResource& operator=(const BuddyMemoryResource&) = delete;
+
+    // Вывод статистики использования памяти
+    void print_stats() const;
+
+    // Методы для тестирования
+    size_t get_allocated_count() const { return allocated_count_; }
+    // Байты в занятых блоках (с округлением до степени двойки)
+    size_t get_allocated_bytes() const { return allocated_bytes_; }
+    // Байты в свободных блоках
+    size_t get_free_bytes() const { return usable_size_ - allocated_bytes_; }
+    // Наибольший свободный блок
+    size_t get_largest_free_block() const;
+    // Внутренняя фрагментация: байты в занятых блоках сверх запрошенных
+    size_t get_internal_fragmentation() const { return allocated_bytes_ - requested_bytes_; }
+    // Внешняя фрагментация от 0 (свободная память в одном блоке) до 1
+    double get_fragmentation() const;
+    // Количество свободных блоков порядка order
+    size_t get_free_count(size_t order) const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Порядок блока, в котором помещаются bytes с выравниванием alignment
+    size_t order_for(size_t bytes, size_t alignment) const;
+
+    // Работа со списками свободных блоков и битовой картой состояний
+    void push_free_block(size_t order, size_t offset);
+    void remove_free_block(size_t order, size_t offset);
+    bool is_free(size_t order, size_t offset) const;
+    void set_free_bit(size_t order, size_t offset, bool value);
+    bool is_allocated(size_t order, size_t offset) const;
+    void set_allocated_bit(size_t order, size_t offset, bool value);
+
+    // Бит блока порядка order в битовой карте и операции с отдельным битом
+    size_t state_bit(size_t order, size_t offset) const;
+    bool test_bit(size_t bit) const;
+    void assign_bit(size_t bit, bool value);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "concurrent_fixed_memory_resource.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Счётчик номеров ресурсов
+std::atomic<uint64_t> next_resource_id{1};
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Метка блока, лежащего в магазине: пишется в начало данных (блок свободен, данные не нужны)
+// Заголовок для этого не годится: соседние блоки центральный пул читает под мьютексом,
+// а магазин работает без него
+// Пользовательские данные, случайно совпавшие с меткой, будут приняты за повторное освобождение
+constexpr uint64_t kCachedMark = 0xCAC4EDB10C4F4EE5;
+
+bool is_cached(const void* ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value == kCachedMark;
+}
+
+void set_cached(void* ptr, bool cached) {
+    uint64_t value = cached ? kCachedMark : 0;
+    std::memcpy(ptr, &value, sizeof(value));
+}
+#endif
+
+}
+
+// Кэши потока для всех ресурсов, с которыми он работал
+// При завершении потока кэши ещё живых ресурсов возвращаются в их центральные пулы
+struct ConcurrentFixedMemoryResource::ThreadCacheList {
+    struct Entry {
+        uint64_t id;
+        std::shared_ptr<Control> control;
+        std::unique_ptr<ThreadCache> cache;
+    };
+
+    std::vector<Entry> entries;
+
+    ~ThreadCacheList() {
+        for (Entry& entry : entries) {
+            std::lock_guard<std::mutex> lock(entry.control->mutex);
+            if (entry.control->owner) {
+                entry.control->owner->flush_all_locked(*entry.cache);
+            }
+        }
+    }
+};
+
+// Конструктор: создаёт центральный пул и общую с кэшами потоков часть
+ConcurrentFixedMemoryResource::ConcurrentFixedMemoryResource(size_t size, AllocationStrategy strategy)
+    : central_(size, strategy), control_(std::make_shared<Control>()),
+      id_(next_resource_id.fetch_add(1, std::memory_order_relaxed)), trim_stop_(false) {
+    control_->owner = this;
+}
+
+// Деструктор: после обнуления owner завершающиеся потоки не обращаются к пулу
+ConcurrentFixedMemoryResource::~ConcurrentFixedMemoryResource() {
+    stop_background_trim();
+    flush_thread_cache();
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    control_->owner = nullptr;
+}
+
+// Выделение: маленькие блоки - из магазина потока, остальные - из центрального пула
+void* ConcurrentFixedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    size_t size_class = class_of(bytes, alignment);
+    if (size_class == kClassCount) {
+        std::lock_guard<std::mutex> lock(control_->mutex);
+        return central_.allocate(bytes, alignment);
+    }
+
+    Magazine& magazine = thread_cache().magazines[size_class];
+    if (magazine.count == 0) {
+        refill(magazine, size_class);
+    }
+    void* ptr = magazine.blocks[--magazine.count];
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    set_cached(ptr, false);
+#endif
+    return ptr;
+}
+
+// Освобождение: маленькие блоки - в магазин потока (полный магазин сначала сбрасывается наполовину)
+void ConcurrentFixedMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    size_t size_class = class_of(bytes, alignment);
+    if (size_class == kClassCount) {
+        std::lock_guard<std::mutex> lock(control_->mutex);
+        central_.deallocate(ptr, bytes, alignment);
+        return;
+    }
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    // Границы пула не меняются, поэтому проверка не требует мьютекса
+    // Полная проверка заголовка выполняется при возврате блока в центральный пул,
+    // а повторное освобождение блока, ещё лежащего в магазине, ловит метка
+    if (!central_.owns(ptr)) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+    if (is_cached(ptr)) {
+        throw std::invalid_argument("Block is already free");
+    }
+    set_cached(ptr, true);
+#endif
+
+    Magazine& magazine = thread_cache().magazines[size_class];
+    if (magazine.count == kMagazineSize) {
+        std::lock_guard<std::mutex> lock(control_->mutex);
+        flush_locked(magazine, size_class, kBatchSize);
+    }
+    magazine.blocks[magazine.count++] = ptr;
+}
+
+// Сравнение memory_resource
+bool ConcurrentFixedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void ConcurrentFixedMemoryResource::flush_thread_cache() {
+    ThreadCache& cache = thread_cache();
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    flush_all_locked(cache);
+}
+
+size_t ConcurrentFixedMemoryResource::trim(TrimAdvice advice) {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    return central_.trim(advice);
+}
+
+// Фоновый поток ждёт на условной переменной, поэтому останавливается сразу, а не по истечении периода
+void ConcurrentFixedMemoryResource::start_background_trim(std::chrono::milliseconds period,
+                                                          TrimAdvice advice) {
+    stop_background_trim();
+    trim_stop_ = false;
+    trim_thread_ = std::thread([this, period, advice] {
+        std::unique_lock<std::mutex> lock(control_->mutex);
+        while (!trim_wakeup_.wait_for(lock, period, [this] { return trim_stop_; })) {
+            central_.trim(advice);
+        }
+    });
+}
+
+void ConcurrentFixedMemoryResource::stop_background_trim() {
+    if (!trim_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(control_->mutex);
+        trim_stop_ = true;
+    }
+    trim_wakeup_.notify_one();
+    trim_thread_.join();
+}
+
+void ConcurrentFixedMemoryResource::print_stats() const {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    central_.print_stats();
+}
+
+size_t ConcurrentFixedMemoryResource::get_allocated_count() const {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    return central_.get_allocated_count();
+}
+
+size_t ConcurrentFixedMemoryResource::get_cached_count() const {
+    size_t count = 0;
+    for (const Magazine& magazine : thread_cache().magazines) {
+        count += magazine.count;
+    }
+    return count;
+}
+
+size_t ConcurrentFixedMemoryResource::get_free_bytes() const {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    return central_.get_free_bytes();
+}
+
+double ConcurrentFixedMemoryResource::get_fragmentation() const {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    return central_.get_fragmentation();
+}
+
+size_t ConcurrentFixedMemoryResource::get_resident_bytes() const {
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    return central_.get_resident_bytes();
+}
+
+// Поиск кэша потока: обычно у потока один-два ресурса, поэтому хватает линейного просмотра
+ConcurrentFixedMemoryResource::ThreadCache& ConcurrentFixedMemoryResource::thread_cache() const {
+    static thread_local ThreadCacheList list;
+
+    for (ThreadCacheList::Entry& entry : list.entries) {
+        if (entry.id == id_) {
+            return *entry.cache;
+        }
+    }
+
+    // Первое обращение потока к ресурсу: заодно убираем кэши уже уничтоженных ресурсов
+    list.entries.erase(
+        std::remove_if(list.entries.begin(), list.entries.end(),
+                       [](const ThreadCacheList::Entry& entry) {
+                           std::lock_guard<std::mutex> lock(entry.control->mutex);
+                           return entry.control->owner == nullptr;
+                       }),
+        list.entries.end());
+
+    list.entries.push_back({id_, control_, std::make_unique<ThreadCache>()});
+    return *list.entries.back().cache;
+}
+
+size_t ConcurrentFixedMemoryResource::class_of(size_t bytes, size_t alignment) {
+    if (bytes > kMaxCachedSize || alignment > kCachedAlignment) {
+        return kClassCount;
+    }
+    return bytes == 0 ? 0 : (bytes - 1) / kCachedAlignment;
+}
+
+// Пополнение: берём из центрального пула до kBatchSize блоков за одну блокировку
+// Если пул исчерпан, довольствуемся тем, что удалось получить
+void ConcurrentFixedMemoryResource::refill(Magazine& magazine, size_t size_class) {
+    size_t size = (size_class + 1) * kCachedAlignment;
+    std::lock_guard<std::mutex> lock(control_->mutex);
+    try {
+        while (magazine.count < kBatchSize) {
+            void* block = central_.allocate(size, kCachedAlignment);
+#if FIXED_MEMORY_RESOURCE_CHECKED
+            set_cached(block, true);
+#endif
+            magazine.blocks[magazine.count++] = block;
+        }
+    } catch (const std::bad_alloc&) {
+        if (magazine.count == 0) {
+            throw;
+        }
+    }
+}
+
+void ConcurrentFixedMemoryResource::flush_locked(Magazine& magazine, size_t size_class, size_t count) {
+    size_t size = (size_class + 1) * kCachedAlignment;
+    while (count-- > 0 && magazine.count > 0) {
+        central_.deallocate(magazine.blocks[--magazine.count], size, kCachedAlignment);
+    }
+}
+
+void ConcurrentFixedMemoryResource::flush_all_locked(ThreadCache& cache) {
+    for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+        flush_locked(cache.magazines[size_class], size_class, kMagazineSize);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#ifndef CONCURRENT_FIXED_MEMORY_RESOURCE_H
+#define CONCURRENT_FIXED_MEMORY_RESOURCE_H
+
+#include "fixed_memory_resource.h"
+#include <memory_resource>
+#include <cstddef>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Потокобезопасный вариант FixedMemoryResource
+// Общий (центральный) пул защищён мьютексом, перед ним у каждого потока свой кэш:
+// для каждого маленького размерного класса - "магазин" указателей на готовые блоки
+// Обычное выделение/освобождение снимает/кладёт указатель в магазин потока без блокировок,
+// мьютекс берётся только при пополнении пустого или сбросе полного магазина,
+// причём блоки переносятся пачками по kBatchSize
+// Блоки больше kMaxCachedSize или с выравниванием больше kCachedAlignment
+// выделяются напрямую из центрального пула под мьютексом
+class ConcurrentFixedMemoryResource : public std::pmr::memory_resource {
+public:
+    // Кэшируются блоки до 256 байт с шагом 16 байт
+    static constexpr size_t kCachedAlignment = 16;
+    static constexpr size_t kMaxCachedSize = 256;
+    static constexpr size_t kClassCount = kMaxCachedSize / kCachedAlignment;
+
+    // Ёмкость магазина и размер пачки при пополнении/сбросе
+    static constexpr size_t kMagazineSize = 64;
+    static constexpr size_t kBatchSize = kMagazineSize / 2;
+
+private:
+    // Магазин одного размерного класса: стек указателей на свободные блоки
+    struct Magazine {
+        void* blocks[kMagazineSize];
+        size_t count;
+    };
+
+    // Кэш одного потока для одного ресурса
+    struct ThreadCache {
+        Magazine magazines[kClassCount];
+    };
+
+    // Общая часть ресурса и кэшей потоков: мьютекс центрального пула и ссылка на ресурс
+    // Переживает ресурс, поэтому поток, завершающийся после уничтожения ресурса,
+    // видит owner == nullptr и не трогает освобождённую память
+    struct Control {
+        std::mutex mutex;
+        ConcurrentFixedMemoryResource* owner;
+    };
+
+    // Кэши текущего потока (thread_local), определение в .cpp
+    struct ThreadCacheList;
+
+    // Центральный пул, доступ только под control_->mutex
+    FixedMemoryResource central_;
+
+    std::shared_ptr<Control> control_;
+
+    // Уникальный номер ресурса, по нему поток находит свой кэш
+    // (адрес не подходит: новый ресурс может занять место уничтоженного)
+    uint64_t id_;
+
+    // Фоновая очистка: поток периодически вызывает trim центрального пула
+    // Флаг остановки защищён control_->mutex
+    std::thread trim_thread_;
+    std::condition_variable trim_wakeup_;
+    bool trim_stop_;
+
+public:
+    // Конструктор: выделяет общий пул заданного размера
+    // size - размер пула в байтах (по умолчанию 1 МБ)
+    // strategy - стратегия поиска свободных блоков в центральном пуле
+    explicit ConcurrentFixedMemoryResource(size_t size = 1024 * 1024,
+                                           AllocationStrategy strategy = AllocationStrategy::SegregatedFit);
+
+    // Деструктор: сбрасывает кэш вызывающего потока и освобождает пул
+    // Кэши других потоков к этому моменту должны быть сброшены (завершением потока
+    // или flush_thread_cache), иначе их блоки считаются неосвобождёнными
+    ~ConcurrentFixedMemoryResource() override;
+
+    // Ресурс уникален: копирование и перемещение запрещены
+    ConcurrentFixedMemoryResource(const ConcurrentFixedMemoryResource&) = delete;
+    ConcurrentFixedMemoryResource& operator=(const ConcurrentFixedMemoryResource&) = delete;
+
+    // Возврат всех блоков из кэша вызывающего потока в центральный пул
+    // При завершении потока это происходит автоматически
+    void flush_thread_cache();
+
+    // Возврат системе свободных страниц центрального пула (см. FixedMemoryResource::trim)
+    // Блоки в кэшах потоков считаются занятыми и не затрагиваются
+    size_t trim(TrimAdvice advice = TrimAdvice::DontNeed);
+
+    // Фоновая очистка: раз в period центральный пул отдаёт свободные страницы системе,
+    // поэтому RSS процесса следует за фактическим заполнением очередей
+    // Повторный вызов меняет период; поток останавливается stop_background_trim или деструктором
+    void start_background_trim(std::chrono::milliseconds period,
+                               TrimAdvice advice = TrimAdvice::DontNeed);
+    void stop_background_trim();
+
+    // Вывод статистики центрального пула
+    void print_stats() const;
+
+    // Снимок статистики центрального пула без захвата мьютекса
+    // Блоки в кэшах потоков считаются занятыми, а выделения и освобождения
+    // считаются по блокам, которые магазины переносят пачками
+    FixedMemoryStats stats() const { return central_.stats(); }
+
+    // Методы для тестирования
+    // Блоки, выданные центральным пулом (включая лежащие в кэшах потоков)
+    size_t get_allocated_count() const;
+    // Блоки в кэше вызывающего потока
+    size_t get_cached_count() const;
+    size_t get_free_bytes() const;
+    double get_fragmentation() const;
+    size_t get_resident_bytes() const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Кэш вызывающего потока для этого ресурса (создаётся при первом обращении)
+    ThreadCache& thread_cache() const;
+
+    // Размерный класс запроса или kClassCount, если запрос не кэшируется
+    static size_t class_of(size_t bytes, size_t alignment);
+
+    // Пополнение пустого магазина пачкой блоков из центрального пула
+    void refill(Magazine& magazine, size_t size_class);
+
+    // Возврат count верхних блоков магазина в центральный пул (мьютекс уже захвачен)
+    void flush_locked(Magazine& magazine, size_t size_class, size_t count);
+
+    // Возврат всего кэша в центральный пул (мьютекс уже захвачен)
+    void flush_all_locked(ThreadCache& cache);
+};
+
+#endif
\ No newline at end of file
@@ -1,149 +1,1838 @@
-#include "fixed_memory_resource.h"
-#include <iostream>
-#include <stdexcept>
-
-// Конструктор: выделяет фиксированный блок памяти
-FixedMemoryResource::FixedMemoryResource(size_t size) 
-    : pool_size_(size), current_offset_(0) {
-    
-    // Выделяем один большой блок памяти через operator new
-    // Этот блок будет использоваться для всех последующих выделений
-    memory_pool_ = ::operator new(pool_size_);
-}
-
-// Деструктор: освобождает блок памяти
-FixedMemoryResource::~FixedMemoryResource() {
-    cleanup();
-}
-
-// Конструктор перемещения: передаёт владение ресурсом
-FixedMemoryResource::FixedMemoryResource(FixedMemoryResource&& other) noexcept
-    : memory_pool_(other.memory_pool_),
-      pool_size_(other.pool_size_),
-      current_offset_(other.current_offset_),
-      allocated_blocks_(std::move(other.allocated_blocks_)),
-      free_blocks_(std::move(other.free_blocks_)) {
-    
-    // Обнуляем источник, чтобы он не освободил память при уничтожении
-    other.memory_pool_ = nullptr;
-    other.pool_size_ = 0;
-    other.current_offset_ = 0;
-}
-
-// Оператор присваивания перемещением
-FixedMemoryResource& FixedMemoryResource::operator=(FixedMemoryResource&& other) noexcept {
-    if (this != &other) {
-        // Освобождаем свои текущие ресурсы
-        cleanup();
-        
-        // Забираем ресурсы из other
-        memory_pool_ = other.memory_pool_;
-        pool_size_ = other.pool_size_;
-        current_offset_ = other.current_offset_;
-        allocated_blocks_ = std::move(other.allocated_blocks_);
-        free_blocks_ = std::move(other.free_blocks_);
-        
-        // Обнуляем источник
-        other.memory_pool_ = nullptr;
-        other.pool_size_ = 0;
-        other.current_offset_ = 0;
-    }
-    return *this;
-}
-
-// Выделение памяти
-void* FixedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
-    // Сначала пытаемся найти подходящий свободный блок для переиспользования
-    void* ptr = find_free_block(bytes, alignment);
-    if (ptr) {
-        // Нашли свободный блок - переиспользуем его
-        allocated_blocks_[ptr] = bytes;
-        return ptr;
-    }
-    
-    // Свободного блока нет - выделяем новый из основного пула
-    
-    // Вычисляем выровненное смещение
-    // Формула: (current + alignment - 1) / alignment * alignment
-    // Это округляет current_offset_ вверх до ближайшего кратного alignment
-    size_t aligned_offset = (current_offset_ + alignment - 1) / alignment * alignment;
-    
-    // Проверяем, достаточно ли места в пуле
-    if (aligned_offset + bytes > pool_size_) {
-        throw std::bad_alloc();
-    }
-    
-    // Вычисляем адрес: начало пула + смещение
-    ptr = static_cast<char*>(memory_pool_) + aligned_offset;
-    
-    // Сохраняем информацию о выделенном блоке в map
-    allocated_blocks_[ptr] = bytes;
-    
-    // Обновляем текущее смещение
-    current_offset_ = aligned_offset + bytes;
-    
-    return ptr;
-}
-
-// Освобождение памяти
-void FixedMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t /*alignment*/) {
-    // Проверяем, что этот блок действительно был выделен нами
-    auto it = allocated_blocks_.find(ptr);
-    if (it == allocated_blocks_.end()) {
-        throw std::invalid_argument("Block not allocated by this resource");
-    }
-    
-    // Удаляем блок из списка активных
-    allocated_blocks_.erase(it);
-    
-    // Добавляем блок в список свободных для последующего переиспользования
-    free_blocks_.insert({bytes, ptr});
-}
-
-// Сравнение memory_resource
-bool FixedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
-    // Два ресурса равны только если это один и тот же объект
-    return this == &other;
-}
-
-// Вывод статистики
-void FixedMemoryResource::print_stats() const {
-    std::cout << "\nСтатистика использования памяти:\n"
-              << "Общий размер: " << pool_size_ << " байт\n"
-              << "Использовано: " << current_offset_ << " байт\n"
-              << "Активных блоков: " << allocated_blocks_.size() << "\n"
-              << "Свободных блоков: " << free_blocks_.size() << "\n\n";
-}
-
-// Поиск свободного блока для переиспользования
-void* FixedMemoryResource::find_free_block(size_t bytes, size_t alignment) {
-    for (auto it = free_blocks_.lower_bound(bytes); it != free_blocks_.end(); ++it) {
-        void* ptr = it->second;
-        
-        // Проверяем, что адрес блока удовлетворяет требованиям выравнивания
-        // reinterpret_cast<uintptr_t> преобразует указатель в целое число
-        if (reinterpret_cast<uintptr_t>(ptr) % alignment == 0) {
-            // Блок подходит - удаляем из списка свободных и возвращаем
-            free_blocks_.erase(it);
-            return ptr;
-        }
-    }
-    
-    // Подходящий блок не найден
-    return nullptr;
-}
-
-// Очистка ресурсов
-void FixedMemoryResource::cleanup() {
-    if (memory_pool_) {
-        // Если остались неосвобождённые блоки - выводим предупреждение
-        if (!allocated_blocks_.empty()) {
-            std::cout << "Внимание: освобождается память с " 
-                      << allocated_blocks_.size() << " неосвобождёнными блоками\n";
-        }
-        
-        // Освобождаем весь блок памяти через operator delete
-        ::operator delete(memory_pool_);
-        memory_pool_ = nullptr;
-    }
+#include "fixed_memory_resource.h"
+#include "allocation_trace.h"
+#include "bit_utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FIXED_MEMORY_RESOURCE_MADVISE 1
+#else
+#define FIXED_MEMORY_RESOURCE_MADVISE 0
+#endif
+
+// Сборка с AddressSanitizer: свободная память пула помечается для него недоступной
+#if defined(__SANITIZE_ADDRESS__)
+#define FIXED_MEMORY_RESOURCE_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FIXED_MEMORY_RESOURCE_ASAN 1
+#endif
+#endif
+
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= 16,
+              "operator new must return blocks aligned to kBlockAlignment");
+
+namespace {
+
+// Корзина гистограммы размеров для запроса bytes
+size_t histogram_bucket(size_t bytes) {
+    if (bytes <= 16) {
+        return 0;
+    }
+    return std::min(floor_log2(bytes - 1) - 3, FixedMemoryStats::kHistogramBuckets - 1);
+}
+
+// Разметка памяти пула для AddressSanitizer, без него - пустые функции
+// Недоступны неразмеченный остаток участков, данные свободных блоков
+// и хвосты занятых блоков за запрошенными байтами
+void asan_poison(const void* start, const void* end) {
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+    const char* first = static_cast<const char*>(start);
+    ASAN_POISON_MEMORY_REGION(first, static_cast<const char*>(end) - first);
+#else
+    (void)start;
+    (void)end;
+#endif
+}
+
+void asan_unpoison(const void* start, const void* end) {
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+    const char* first = static_cast<const char*>(start);
+    ASAN_UNPOISON_MEMORY_REGION(first, static_cast<const char*>(end) - first);
+#else
+    (void)start;
+    (void)end;
+#endif
+}
+
+// Можно ли читать size байт с адреса ptr (под AddressSanitizer - не помечены ли они)
+// Нужно проверкам, которые читают заголовки по непроверенному указателю
+bool asan_readable(const void* ptr, size_t size) {
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+    return __asan_region_is_poisoned(const_cast<void*>(ptr), size) == nullptr;
+#else
+    (void)ptr;
+    (void)size;
+    return true;
+#endif
+}
+
+#if FIXED_MEMORY_RESOURCE_HARDENED
+// Узоры усиленного режима: контрольные байты за данными и данные свободных блоков
+constexpr unsigned char kGuardByte = 0xAB;
+constexpr unsigned char kFreedByte = 0xDD;
+
+void fill_pattern(char* start, char* end, unsigned char pattern) {
+    if (start < end) {
+        std::fill(start, end, static_cast<char>(pattern));
+    }
+}
+
+bool has_pattern(const char* start, const char* end, unsigned char pattern) {
+    return std::all_of(start, end, [pattern](char c) {
+        return static_cast<unsigned char>(c) == pattern;
+    });
+}
+#endif
+
+}
+
+// Конструктор: выделяет фиксированный блок памяти
+FixedMemoryResource::FixedMemoryResource(size_t size, AllocationStrategy strategy)
+    : FixedMemoryResource(FixedMemoryResourceOptions{size, strategy}) {}
+
+// Конструктор с параметрами: выделяет первый участок пула
+FixedMemoryResource::FixedMemoryResource(const FixedMemoryResourceOptions& options)
+    : pool_size_(options.initial_size), current_offset_(0), top_prev_size_(0), allocated_count_(0),
+      internal_fragmentation_(0), strategy_(options.strategy), chunk_count_(1),
+      total_size_(options.initial_size), external_chunks_(options.buffer != nullptr ? 1 : 0),
+      snapshot_mapping_(nullptr), snapshot_mapping_size_(0), snapshot_root_(nullptr),
+      upstream_(options.upstream),
+      growth_factor_(std::max<size_t>(options.growth_factor, 1)),
+      max_total_size_(options.max_total_size), marker_depth_(0), deferred_(nullptr),
+      deferred_count_(0), deferred_fragmentation_(0), trace_(nullptr) {
+
+    clear_free_lists();
+
+    if (external_chunks_ != 0) {
+        // Память первого участка предоставлена вызывающим
+        if (reinterpret_cast<uintptr_t>(options.buffer) % kBlockAlignment != 0) {
+            throw std::invalid_argument("Pool buffer must be aligned to 16 bytes");
+        }
+        memory_pool_ = options.buffer;
+        if (upstream_) {
+            total_size_ = options.initial_size & ~(kBlockAlignment - 1);
+            if (total_size_ < kMinBlockSize + kHeaderSize) {
+                throw std::invalid_argument("Pool buffer is too small");
+            }
+            pool_size_ = total_size_ - kHeaderSize;
+        }
+    } else if (!upstream_) {
+        // Выделяем один большой блок памяти через operator new
+        // Этот блок будет использоваться для всех последующих выделений
+        memory_pool_ = ::operator new(pool_size_);
+    } else {
+        // Растущий пул: все участки берутся у upstream, в конце каждого - место под заграждение
+        total_size_ = align_up(std::max(options.initial_size, kMinBlockSize), kBlockAlignment);
+        memory_pool_ = upstream_->allocate(total_size_, kBlockAlignment);
+        pool_size_ = total_size_ - kHeaderSize;
+    }
+    chunks_[0] = {memory_pool_, total_size_, 0, memory_pool_};
+    asan_poison(memory_pool_, static_cast<char*>(memory_pool_) + total_size_);
+}
+
+// Деструктор: освобождает блок памяти
+FixedMemoryResource::~FixedMemoryResource() {
+    cleanup();
+}
+
+// Конструктор перемещения: передаёт владение ресурсом
+FixedMemoryResource::FixedMemoryResource(FixedMemoryResource&& other) noexcept
+    : memory_pool_(other.memory_pool_),
+      pool_size_(other.pool_size_),
+      current_offset_(other.current_offset_),
+      top_prev_size_(other.top_prev_size_),
+      allocated_count_(other.allocated_count_),
+      internal_fragmentation_(other.internal_fragmentation_),
+      bytes_in_use_(other.bytes_in_use_),
+      peak_bytes_in_use_(other.peak_bytes_in_use_),
+      allocations_(other.allocations_),
+      deallocations_(other.deallocations_),
+      free_list_hits_(other.free_list_hits_),
+      bump_allocations_(other.bump_allocations_),
+      failed_allocations_(other.failed_allocations_),
+      strategy_(other.strategy_),
+      first_level_bitmap_(other.first_level_bitmap_),
+      free_count_(other.free_count_),
+      free_bytes_(other.free_bytes_),
+      chunk_count_(other.chunk_count_),
+      total_size_(other.total_size_),
+      external_chunks_(other.external_chunks_),
+      snapshot_mapping_(other.snapshot_mapping_),
+      snapshot_mapping_size_(other.snapshot_mapping_size_),
+      snapshot_root_(other.snapshot_root_),
+      upstream_(other.upstream_),
+      growth_factor_(other.growth_factor_),
+      max_total_size_(other.max_total_size_),
+      marker_depth_(other.marker_depth_),
+      deferred_(other.deferred_),
+      deferred_count_(other.deferred_count_),
+      deferred_fragmentation_(other.deferred_fragmentation_),
+      trace_(other.trace_) {
+
+    std::copy(&other.free_lists_[0][0], &other.free_lists_[0][0] + kFirstLevelCount * kSecondLevelCount,
+              &free_lists_[0][0]);
+    std::copy(std::begin(other.second_level_bitmaps_), std::end(other.second_level_bitmaps_),
+              second_level_bitmaps_);
+    std::copy(other.chunks_, other.chunks_ + other.chunk_count_, chunks_);
+    std::copy(std::begin(other.size_histogram_), std::end(other.size_histogram_), size_histogram_);
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    allocate_latency_ = other.allocate_latency_;
+    deallocate_latency_ = other.deallocate_latency_;
+#endif
+
+    // Обнуляем источник, чтобы он не освободил память при уничтожении
+    other.memory_pool_ = nullptr;
+    other.pool_size_ = 0;
+    other.current_offset_ = 0;
+    other.top_prev_size_ = 0;
+    other.allocated_count_ = 0;
+    other.internal_fragmentation_ = 0;
+    other.bytes_in_use_ = 0;
+    other.chunk_count_ = 0;
+    other.total_size_ = 0;
+    other.marker_depth_ = 0;
+    other.deferred_ = nullptr;
+    other.deferred_count_ = 0;
+    other.deferred_fragmentation_ = 0;
+    other.trace_ = nullptr;
+    other.snapshot_mapping_ = nullptr;
+    other.snapshot_root_ = nullptr;
+    other.clear_free_lists();
+}
+
+// Оператор присваивания перемещением
+FixedMemoryResource& FixedMemoryResource::operator=(FixedMemoryResource&& other) noexcept {
+    if (this != &other) {
+        // Освобождаем свои текущие ресурсы
+        cleanup();
+
+        // Забираем ресурсы из other
+        memory_pool_ = other.memory_pool_;
+        pool_size_ = other.pool_size_;
+        current_offset_ = other.current_offset_;
+        top_prev_size_ = other.top_prev_size_;
+        allocated_count_ = other.allocated_count_;
+        internal_fragmentation_ = other.internal_fragmentation_;
+        bytes_in_use_ = other.bytes_in_use_;
+        peak_bytes_in_use_ = other.peak_bytes_in_use_;
+        allocations_ = other.allocations_;
+        deallocations_ = other.deallocations_;
+        free_list_hits_ = other.free_list_hits_;
+        bump_allocations_ = other.bump_allocations_;
+        failed_allocations_ = other.failed_allocations_;
+        strategy_ = other.strategy_;
+        std::copy(&other.free_lists_[0][0],
+                  &other.free_lists_[0][0] + kFirstLevelCount * kSecondLevelCount, &free_lists_[0][0]);
+        std::copy(std::begin(other.second_level_bitmaps_), std::end(other.second_level_bitmaps_),
+                  second_level_bitmaps_);
+        first_level_bitmap_ = other.first_level_bitmap_;
+        free_count_ = other.free_count_;
+        free_bytes_ = other.free_bytes_;
+        std::copy(other.chunks_, other.chunks_ + other.chunk_count_, chunks_);
+        std::copy(std::begin(other.size_histogram_), std::end(other.size_histogram_), size_histogram_);
+#if FIXED_MEMORY_RESOURCE_LATENCY
+        allocate_latency_ = other.allocate_latency_;
+        deallocate_latency_ = other.deallocate_latency_;
+#endif
+        chunk_count_ = other.chunk_count_;
+        total_size_ = other.total_size_;
+        external_chunks_ = other.external_chunks_;
+        snapshot_mapping_ = other.snapshot_mapping_;
+        snapshot_mapping_size_ = other.snapshot_mapping_size_;
+        snapshot_root_ = other.snapshot_root_;
+        upstream_ = other.upstream_;
+        growth_factor_ = other.growth_factor_;
+        max_total_size_ = other.max_total_size_;
+        marker_depth_ = other.marker_depth_;
+        deferred_ = other.deferred_;
+        deferred_count_ = other.deferred_count_;
+        deferred_fragmentation_ = other.deferred_fragmentation_;
+        trace_ = other.trace_;
+
+        // Обнуляем источник
+        other.memory_pool_ = nullptr;
+        other.pool_size_ = 0;
+        other.current_offset_ = 0;
+        other.top_prev_size_ = 0;
+        other.allocated_count_ = 0;
+        other.internal_fragmentation_ = 0;
+        other.bytes_in_use_ = 0;
+        other.chunk_count_ = 0;
+        other.total_size_ = 0;
+        other.marker_depth_ = 0;
+        other.deferred_ = nullptr;
+        other.deferred_count_ = 0;
+        other.deferred_fragmentation_ = 0;
+        other.trace_ = nullptr;
+        other.snapshot_mapping_ = nullptr;
+        other.snapshot_root_ = nullptr;
+        other.clear_free_lists();
+    }
+    return *this;
+}
+
+// Выделение памяти
+void* FixedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    LatencyTimer timer(allocate_latency_);
+#endif
+
+    if (bytes > kMaxRequestSize) {
+        ++allocations_;
+        ++failed_allocations_;
+        throw std::bad_alloc();
+    }
+
+    // Полный размер блока: заголовок + данные (+ контрольные байты), округлённые до kBlockAlignment
+    size_t size = std::max(align_up(kHeaderSize + bytes + kGuardSize, kBlockAlignment), kMinBlockSize);
+    ++allocations_;
+    ++size_histogram_[histogram_bucket(bytes)];
+
+    // Сначала пытаемся найти подходящий свободный блок для переиспользования
+    if (BlockHeader* free_block = find_free_block(size, alignment)) {
+        char* block = reinterpret_cast<char*>(free_block);
+        asan_unpoison(block + kMinBlockSize, block + block_size(free_block));
+#if FIXED_MEMORY_RESOURCE_HARDENED
+        check_freed(free_block);
+#endif
+
+        // Нашли свободный блок - размещаем в нём выровненные данные,
+        // лишние части возвращаем в пул
+        void* ptr = place_block(free_block, size, alignment);
+        guard_block(ptr, bytes);
+        size_t placed = block_size(header_of(ptr));
+        ++allocated_count_;
+        internal_fragmentation_ += placed - kHeaderSize - bytes;
+        ++free_list_hits_;
+        bytes_in_use_ += placed;
+        peak_bytes_in_use_.raise_to(bytes_in_use_);
+        if (trace_) {
+            trace_->record(TraceOp::Allocate, bytes, alignment, ptr, marker_depth_);
+        }
+        return ptr;
+    }
+
+    // Свободного блока нет - выделяем новый из основного пула
+
+    // Вычисляем выровненное смещение блока
+    // Данные идут сразу за заголовком, поэтому выравнивается адрес после заголовка
+    // Промежуток перед блоком оформляется отдельным свободным блоком,
+    // поэтому он либо пустой, либо не меньше минимального блока
+    size_t gap = aligned_lead(top(), alignment);
+
+    // Проверяем, достаточно ли места в пуле
+    // Если нет - растущий пул подключает следующий участок, фиксированный выбрасывает bad_alloc
+    if (current_offset_ + gap + size > pool_size_) {
+        try {
+            add_chunk(alignment > kBlockAlignment ? size + alignment + kMinBlockSize : size);
+        } catch (const std::bad_alloc&) {
+            ++failed_allocations_;
+            throw;
+        }
+        gap = aligned_lead(top(), alignment);
+    }
+
+    char* base = static_cast<char*>(memory_pool_);
+    size_t block_offset = current_offset_ + gap;
+    asan_unpoison(base + current_offset_, base + block_offset + size);
+
+    // Записываем заголовок нового блока
+    auto* header = reinterpret_cast<BlockHeader*>(base + block_offset);
+    header->prev_size = gap != 0 ? gap : top_prev_size_;
+    header->size = size | kInUseFlag | depth_bits();
+
+    BlockHeader* gap_header = nullptr;
+    if (gap != 0) {
+        gap_header = reinterpret_cast<BlockHeader*>(base + current_offset_);
+        gap_header->prev_size = top_prev_size_;
+        gap_header->size = gap | depth_bits();
+    }
+
+    // Обновляем текущее смещение
+    current_offset_ = block_offset + size;
+    top_prev_size_ = size;
+    ++allocated_count_;
+    internal_fragmentation_ += size - kHeaderSize - bytes;
+    ++bump_allocations_;
+    bytes_in_use_ += size;
+    peak_bytes_in_use_.raise_to(bytes_in_use_);
+
+    // Промежуток выравнивания становится свободным блоком
+    // Освобождаем его после сдвига current_offset_, чтобы он не был принят за вершину пула
+    if (gap_header) {
+        release_block(gap_header);
+    }
+    guard_block(header + 1, bytes);
+
+    if (trace_) {
+        trace_->record(TraceOp::Allocate, bytes, alignment, header + 1, marker_depth_);
+    }
+    return header + 1;
+}
+
+// Освобождение памяти
+void FixedMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    LatencyTimer timer(deallocate_latency_);
+#endif
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    // Проверяем, что этот блок действительно был выделен нами
+    validate_block(ptr, bytes);
+#else
+    (void)bytes;
+#endif
+    check_guard(ptr, bytes);
+
+    if (trace_) {
+        trace_->record(TraceOp::Deallocate, bytes, alignment, ptr);
+    }
+
+    BlockHeader* header = header_of(ptr);
+    size_t fragmentation = block_size(header) - kHeaderSize - bytes;
+    internal_fragmentation_ -= fragmentation;
+    --allocated_count_;
+    ++deallocations_;
+    bytes_in_use_ -= block_size(header);
+
+    // Блок, выделенный до активной метки, возвращается в пул только при откате к ней
+    if (depth_of(header) < marker_depth_) {
+        defer_release(header, fragmentation);
+        return;
+    }
+
+    // Возвращаем блок в пул: он сливается со свободными соседями
+    // и попадает в список свободных для последующего переиспользования
+    release_block(header);
+}
+
+// Пакетное выделение
+void FixedMemoryResource::allocate_bulk(void** out, size_t count, size_t bytes, size_t alignment) {
+    if (count == 0) {
+        return;
+    }
+    if (bytes > kMaxRequestSize) {
+        failed_allocations_ += count;
+        allocations_ += count;
+        throw std::bad_alloc();
+    }
+    size_t size = std::max(align_up(kHeaderSize + bytes + kGuardSize, kBlockAlignment), kMinBlockSize);
+
+    // При выравнивании до kBlockAlignment блоки встают на вершину без промежутков
+    bool contiguous = alignment <= kBlockAlignment && count <= (pool_size_ - current_offset_) / size;
+    if (!contiguous && alignment <= kBlockAlignment && upstream_ &&
+        count <= (std::numeric_limits<size_t>::max() - kMinBlockSize) / size) {
+        try {
+            add_chunk(count * size);
+            contiguous = true;
+        } catch (const std::bad_alloc&) {
+            // Новый участок не дали - пробуем свободные блоки по одному
+        }
+    }
+
+    if (!contiguous) {
+        size_t done = 0;
+        try {
+            for (; done < count; ++done) {
+                out[done] = do_allocate(bytes, alignment);
+            }
+        } catch (...) {
+            // В обратном порядке: блоки у вершины возвращаются сдвигом смещения
+            while (done > 0) {
+                --done;
+                do_deallocate(out[done], bytes, alignment);
+            }
+            throw;
+        }
+        return;
+    }
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    LatencyTimer timer(allocate_latency_);
+#endif
+    char* start = top();
+    asan_unpoison(start, start + count * size);
+    size_t prev_size = top_prev_size_;
+    size_t flags = kInUseFlag | depth_bits();
+    for (size_t index = 0; index < count; ++index) {
+        auto* header = reinterpret_cast<BlockHeader*>(start + index * size);
+        header->prev_size = prev_size;
+        header->size = size | flags;
+        prev_size = size;
+        out[index] = header + 1;
+        guard_block(header + 1, bytes);
+        if (trace_) {
+            trace_->record(TraceOp::Allocate, bytes, alignment, header + 1, marker_depth_);
+        }
+    }
+
+    current_offset_ += count * size;
+    top_prev_size_ = size;
+    allocated_count_ += count;
+    internal_fragmentation_ += count * (size - kHeaderSize - bytes);
+    allocations_ += count;
+    bump_allocations_ += count;
+    size_histogram_[histogram_bucket(bytes)] += count;
+    bytes_in_use_ += count * size;
+    peak_bytes_in_use_.raise_to(bytes_in_use_);
+}
+
+// Увеличение блока на месте: за счёт вершины или свободного соседа справа
+bool FixedMemoryResource::try_expand(void* ptr, size_t old_bytes, size_t new_bytes) {
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    validate_block(ptr, old_bytes);
+#endif
+    if (new_bytes > kMaxRequestSize) {
+        return false;
+    }
+    BlockHeader* header = header_of(ptr);
+    char* start = reinterpret_cast<char*>(header);
+    size_t size = block_size(header);
+    size_t new_size = std::max(align_up(kHeaderSize + new_bytes + kGuardSize, kBlockAlignment), kMinBlockSize);
+
+    if (new_size > size) {
+        // Блок другой глубины лежит по ту сторону границы метки
+        if (depth_of(header) != marker_depth_) {
+            return false;
+        }
+
+        char* end = start + size;
+        if (end == top()) {
+            // Блок у вершины: вершина сдвигается на прирост
+            if (new_size - size > pool_size_ - current_offset_) {
+                return false;
+            }
+            check_guard(ptr, old_bytes);
+            asan_unpoison(end, start + new_size);
+            current_offset_ += new_size - size;
+            top_prev_size_ = new_size;
+            header->size = new_size | kInUseFlag | depth_bits();
+        } else {
+            // Справа свободный блок: поглощаем его, лишнее отрезается обратно в пул
+            // (заграждение закрытого участка помечено занятым и сюда не попадает)
+            auto* next = reinterpret_cast<BlockHeader*>(end);
+            if ((next->size & kInUseFlag) || depth_of(next) != marker_depth_ ||
+                size + block_size(next) < new_size) {
+                return false;
+            }
+            check_guard(ptr, old_bytes);
+            size_t combined = size + block_size(next);
+            remove_free_block(next);
+            asan_unpoison(end + kMinBlockSize, start + combined);
+#if FIXED_MEMORY_RESOURCE_HARDENED
+            try {
+                check_freed(next);
+            } catch (...) {
+                guard_block(ptr, old_bytes);
+                throw;
+            }
+#endif
+            header->size = combined | depth_bits();
+            set_next_prev_size(start + combined, combined);
+            split_block(header, new_size);
+            header->size |= kInUseFlag;
+        }
+    } else {
+        // Новый размер помещается в хвост округления самого блока
+        check_guard(ptr, old_bytes);
+    }
+
+    record_resize(ptr, size, old_bytes, new_bytes);
+    guard_block(ptr, new_bytes);
+    return true;
+}
+
+// Уменьшение блока на месте: хвост освобождается как отдельный блок
+void FixedMemoryResource::shrink(void* ptr, size_t old_bytes, size_t new_bytes) {
+    if (new_bytes > old_bytes) {
+        throw std::invalid_argument("New size is larger than the block");
+    }
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    validate_block(ptr, old_bytes);
+#endif
+    check_guard(ptr, old_bytes);
+
+    BlockHeader* header = header_of(ptr);
+    char* start = reinterpret_cast<char*>(header);
+    size_t size = block_size(header);
+    size_t new_size = std::max(align_up(kHeaderSize + new_bytes + kGuardSize, kBlockAlignment), kMinBlockSize);
+
+    // Хвост блока, выделенного до активной метки, не возвращаем:
+    // откат восстанавливает списки свободных и потерял бы его
+    if (size - new_size >= kMinBlockSize && depth_of(header) == marker_depth_) {
+        auto* tail = reinterpret_cast<BlockHeader*>(start + new_size);
+        tail->prev_size = new_size;
+        tail->size = (size - new_size) | kInUseFlag | depth_bits();
+        header->size = new_size | kInUseFlag | depth_bits();
+        release_block(tail);
+    }
+
+    record_resize(ptr, size, old_bytes, new_bytes);
+    guard_block(ptr, new_bytes);
+}
+
+// Сравнение memory_resource
+bool FixedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    // Два ресурса равны только если это один и тот же объект
+    return this == &other;
+}
+
+// Вывод статистики
+void FixedMemoryResource::print_stats() const {
+    std::cout << "\nСтатистика использования памяти:\n"
+              << "Общий размер: " << total_size_ << " байт\n";
+    if (upstream_) {
+        std::cout << "Участков: " << chunk_count_ << "\n";
+    }
+    std::cout
+              << "Использовано: " << current_offset_ << " байт\n"
+              << "Активных блоков: " << allocated_count_ << "\n"
+              << "Свободных блоков: " << free_count_ << "\n"
+              << "Фрагментация: " << get_fragmentation() * 100.0 << "%\n"
+              << "Внутренняя фрагментация: " << internal_fragmentation_ << " байт\n\n";
+}
+
+// Снимок статистики из счётчиков
+FixedMemoryStats FixedMemoryResource::stats() const {
+    FixedMemoryStats result;
+    result.bytes_in_use = bytes_in_use_;
+    result.peak_bytes_in_use = peak_bytes_in_use_;
+    result.allocations = allocations_;
+    result.deallocations = deallocations_;
+    result.free_list_hits = free_list_hits_;
+    result.bump_allocations = bump_allocations_;
+    result.failed_allocations = failed_allocations_;
+    result.internal_fragmentation = internal_fragmentation_;
+    std::copy(std::begin(size_histogram_), std::end(size_histogram_), result.size_histogram);
+
+    // Счётчики читаются не одновременно, поэтому разность может оказаться "отрицательной"
+    size_t total = total_size_;
+    size_t free_total = total > result.bytes_in_use ? total - result.bytes_in_use : 0;
+    size_t fragmented = std::min<size_t>(free_bytes_, free_total);
+    result.external_fragmentation =
+        free_total == 0 ? 0.0 : static_cast<double>(fragmented) / static_cast<double>(free_total);
+    return result;
+}
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+void FixedMemoryResource::print_latency() const {
+    std::cout << "\nЗадержки выделения памяти:\n";
+    allocate_latency_.print(std::cout, "allocate");
+    deallocate_latency_.print(std::cout, "deallocate");
+}
+
+void FixedMemoryResource::reset_latency() {
+    allocate_latency_.reset();
+    deallocate_latency_.reset();
+}
+#endif
+
+// Сброс пула целиком
+void FixedMemoryResource::release() {
+    if (!memory_pool_) {
+        return;
+    }
+    if (trace_) {
+        trace_->record(TraceOp::Release, 0, 0, nullptr);
+    }
+
+    // Участки, подключённые при росте, больше не нужны
+    for (size_t index = 1; index < chunk_count_; ++index) {
+        free_chunk(index);
+    }
+    chunk_count_ = 1;
+    external_chunks_ = std::min<size_t>(external_chunks_, 1);
+    snapshot_root_ = nullptr;
+    total_size_ = chunks_[0].size;
+    memory_pool_ = chunks_[0].memory;
+    pool_size_ = upstream_ ? chunks_[0].size - kHeaderSize : chunks_[0].size;
+    asan_poison(memory_pool_, static_cast<char*>(memory_pool_) + chunks_[0].size);
+
+    current_offset_ = 0;
+    top_prev_size_ = 0;
+    allocated_count_ = 0;
+    internal_fragmentation_ = 0;
+    bytes_in_use_ = 0;
+    clear_free_lists();
+
+    // Все метки теряют смысл
+    marker_depth_ = 0;
+    deferred_ = nullptr;
+    deferred_count_ = 0;
+    deferred_fragmentation_ = 0;
+}
+
+// Метка: снимок состояния пула фиксированного размера, поэтому O(1)
+FixedMemoryResource::Marker FixedMemoryResource::mark() {
+    if (marker_depth_ + 1 >= (size_t{1} << (64 - kDepthShift))) {
+        throw std::length_error("Too many nested markers");
+    }
+
+    Marker marker;
+    marker.depth_ = marker_depth_;
+    marker.memory_pool_ = memory_pool_;
+    marker.pool_size_ = pool_size_;
+    marker.current_offset_ = current_offset_;
+    marker.top_prev_size_ = top_prev_size_;
+    marker.chunk_count_ = chunk_count_;
+    marker.total_size_ = total_size_;
+    marker.allocated_count_ = allocated_count_;
+    marker.internal_fragmentation_ = internal_fragmentation_;
+    marker.bytes_in_use_ = bytes_in_use_;
+    std::copy(&free_lists_[0][0], &free_lists_[0][0] + kFirstLevelCount * kSecondLevelCount,
+              &marker.free_lists_[0][0]);
+    marker.first_level_bitmap_ = first_level_bitmap_;
+    std::copy(std::begin(second_level_bitmaps_), std::end(second_level_bitmaps_),
+              marker.second_level_bitmaps_);
+    marker.free_count_ = free_count_;
+    marker.free_bytes_ = free_bytes_;
+    marker.deferred_ = deferred_;
+    marker.deferred_count_ = deferred_count_;
+    marker.deferred_fragmentation_ = deferred_fragmentation_;
+
+    // Фаза начинается с пустых списков: свободные блоки до метки остаются нетронутыми,
+    // поэтому при откате достаточно вернуть сохранённые головы списков
+    clear_free_lists();
+    deferred_ = nullptr;
+    deferred_count_ = 0;
+    deferred_fragmentation_ = 0;
+    ++marker_depth_;
+    return marker;
+}
+
+// Откат к метке
+size_t FixedMemoryResource::rollback(const Marker& marker) {
+    if (marker.depth_ + 1 != marker_depth_) {
+        throw std::invalid_argument("Marker is not the innermost active marker");
+    }
+
+    // Занятые блоки фазы: отложенные освобождения уже вычтены из allocated_count_,
+    // но относятся к блокам, выделенным до метки
+    size_t live = allocated_count_ + deferred_count_ - marker.allocated_count_;
+    if (trace_) {
+        trace_->record(TraceOp::Rollback, live, 0, nullptr, marker.depth_);
+    }
+
+    // Освобождаемая часть участка метки снова становится неразмеченным остатком
+    // С проверками заполняем её мусором
+    char* line = static_cast<char*>(marker.memory_pool_) + marker.current_offset_;
+    const Chunk& chunk = chunks_[marker.chunk_count_ - 1];
+    char* end = marker.chunk_count_ == chunk_count_
+        ? top()
+        : static_cast<char*>(chunk.memory) + chunk.used + kHeaderSize;
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    asan_unpoison(line, end);
+    std::fill(line, end, static_cast<char>(0xDD));
+#endif
+    asan_poison(line, end);
+
+    // Участки, подключённые после метки, возвращаются upstream
+    for (size_t index = marker.chunk_count_; index < chunk_count_; ++index) {
+        asan_unpoison(chunks_[index].memory, static_cast<char*>(chunks_[index].memory) + chunks_[index].size);
+        upstream_->deallocate(chunks_[index].memory, chunks_[index].size, kBlockAlignment);
+    }
+
+    DeferredNode* deferred = deferred_;
+    size_t deferred_count = deferred_count_;
+    size_t deferred_fragmentation = deferred_fragmentation_;
+
+    memory_pool_ = marker.memory_pool_;
+    pool_size_ = marker.pool_size_;
+    current_offset_ = marker.current_offset_;
+    top_prev_size_ = marker.top_prev_size_;
+    chunk_count_ = marker.chunk_count_;
+    total_size_ = marker.total_size_;
+    allocated_count_ = marker.allocated_count_ - deferred_count;
+    internal_fragmentation_ = marker.internal_fragmentation_ - deferred_fragmentation;
+    std::copy(&marker.free_lists_[0][0], &marker.free_lists_[0][0] + kFirstLevelCount * kSecondLevelCount,
+              &free_lists_[0][0]);
+    first_level_bitmap_ = marker.first_level_bitmap_;
+    std::copy(std::begin(marker.second_level_bitmaps_), std::end(marker.second_level_bitmaps_),
+              second_level_bitmaps_);
+    free_count_ = marker.free_count_;
+    free_bytes_ = marker.free_bytes_;
+    deferred_ = marker.deferred_;
+    deferred_count_ = marker.deferred_count_;
+    deferred_fragmentation_ = marker.deferred_fragmentation_;
+    --marker_depth_;
+
+    // Отложенные освобождения выполняются заново уже на восстановленном уровне
+    // Сначала все такие блоки снова помечаются занятыми, чтобы они не сливались
+    // друг с другом раньше, чем попадут в списки
+    size_t deferred_bytes = 0;
+    for (DeferredNode* node = deferred; node; node = node->next) {
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(node) - 1;
+        header->size |= kInUseFlag;
+        deferred_bytes += block_size(header);
+    }
+    bytes_in_use_ = marker.bytes_in_use_ - deferred_bytes;
+    while (deferred) {
+        DeferredNode* node = deferred;
+        deferred = node->next;
+        auto* header = reinterpret_cast<BlockHeader*>(node) - 1;
+        if (depth_of(header) < marker_depth_) {
+            defer_release(header, node->fragmentation);
+        } else {
+            release_block(header);
+        }
+    }
+    return live;
+}
+
+// Проверка после отката: пул уже согласован, исключение только сообщает об утечке в фазе
+size_t FixedMemoryResource::rollback(const Marker& marker, size_t expected_live) {
+    size_t live = rollback(marker);
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    if (live != expected_live) {
+        throw std::logic_error("Blocks allocated after the marker are still live");
+    }
+#else
+    (void)expected_live;
+#endif
+    return live;
+}
+
+namespace {
+
+size_t system_page_size() {
+#if FIXED_MEMORY_RESOURCE_MADVISE
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+#else
+    return 4096;
+#endif
+}
+
+// Резидентные байты в [start, start + size)
+// Без mincore (не Linux) считаем резидентным весь диапазон
+size_t resident_bytes(const char* start, size_t size) {
+#ifdef __linux__
+    size_t page = system_page_size();
+    uintptr_t first = reinterpret_cast<uintptr_t>(start) & ~(page - 1);
+    uintptr_t last = align_up(reinterpret_cast<uintptr_t>(start) + size, page);
+    size_t pages = (last - first) / page;
+
+    // Размер вектора mincore ограничен, поэтому обходим диапазон порциями
+    unsigned char residency[256];
+    size_t resident = 0;
+    for (size_t done = 0; done < pages; done += sizeof(residency)) {
+        size_t count = std::min(pages - done, sizeof(residency));
+        if (mincore(reinterpret_cast<void*>(first + done * page), count * page, residency) != 0) {
+            return size;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            resident += (residency[i] & 1) * page;
+        }
+    }
+    return resident;
+#else
+    (void)start;
+    return size;
+#endif
+}
+
+// Возврат системе страниц, целиком лежащих внутри [start, end)
+// Возвращает, сколько байт из них было резидентно
+size_t release_pages(char* start, char* end, TrimAdvice advice) {
+#if FIXED_MEMORY_RESOURCE_MADVISE
+    size_t page = system_page_size();
+    uintptr_t first = align_up(reinterpret_cast<uintptr_t>(start), page);
+    uintptr_t last = reinterpret_cast<uintptr_t>(end) & ~(page - 1);
+    if (last <= first) {
+        return 0;
+    }
+
+    auto* region = reinterpret_cast<char*>(first);
+    size_t size = last - first;
+    size_t resident = resident_bytes(region, size);
+    if (resident == 0) {
+        return 0;
+    }
+
+    int flag = MADV_DONTNEED;
+#ifdef MADV_FREE
+    if (advice == TrimAdvice::Free) {
+        flag = MADV_FREE;
+    }
+#endif
+    // Ошибка не критична (например, участок из hugetlbfs не делится на обычные страницы):
+    // память просто остаётся резидентной
+    return madvise(region, size, flag) == 0 ? resident : 0;
+#else
+    (void)start;
+    (void)end;
+    (void)advice;
+    return 0;
+#endif
+}
+
+}
+
+// Возврат свободных страниц системе
+size_t FixedMemoryResource::trim(TrimAdvice advice) {
+    if (!memory_pool_) {
+        return 0;
+    }
+
+    // Неразмеченный остаток текущего участка свободен целиком
+    size_t released = release_pages(top(), static_cast<char*>(memory_pool_) + pool_size_, advice);
+
+#if !FIXED_MEMORY_RESOURCE_HARDENED
+    // Свободные блоки: страницу могут занимать только блоки не меньше страницы,
+    // поэтому просматриваем строки сетки начиная с класса размера страницы
+    // В усиленном режиме их не трогаем: возвращённые страницы обнулятся и сотрут узор
+    size_t page = system_page_size();
+    for (size_t first = list_index_of(page).first; first < kFirstLevelCount; ++first) {
+        if (!(first_level_bitmap_ & (uint64_t{1} << first))) {
+            continue;
+        }
+        for (size_t second = 0; second < kSecondLevelCount; ++second) {
+            for (FreeNode* node = free_lists_[first][second]; node; node = node->next) {
+                char* block = reinterpret_cast<char*>(header_of(node));
+                released += release_pages(block + kMinBlockSize, block + block_size(header_of(node)),
+                                          advice);
+            }
+        }
+    }
+#endif
+    return released;
+}
+
+size_t FixedMemoryResource::get_resident_bytes() const {
+    size_t resident = 0;
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        resident += resident_bytes(static_cast<const char*>(chunks_[index].memory), chunks_[index].size);
+    }
+    return resident;
+}
+
+// Снимки пула
+
+namespace {
+
+constexpr uint64_t kSnapshotMagic = 0x4c4f'4f50'3542'414c;   // "LAB5POOL"
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr uint64_t kNoSnapshotRoot = ~uint64_t{0};
+
+// Участки в файле выровнены с запасом на любой размер страницы:
+// после отображения каждый участок начинается с границы страницы (это нужно trim)
+constexpr size_t kSnapshotAlignment = 64 * 1024;
+
+// Заголовок файла снимка, за ним - таблица участков (SnapshotChunk), затем участки
+struct SnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+
+    // Раскладка блоков: снимок подходит только сборке с такой же раскладкой
+    uint32_t block_header_size;
+    uint32_t block_alignment;
+    uint32_t guard_size;
+
+    uint32_t strategy;
+    // В конце участков зарезервировано место под заграждение (пул был растущим)
+    uint32_t fence_reserved;
+    uint64_t growth_factor;
+    uint64_t max_total_size;
+
+    uint64_t chunk_count;
+    uint64_t current_offset;
+    uint64_t top_prev_size;
+    uint64_t root_chunk;
+    uint64_t root_offset;
+
+    // Счётчики, которые нельзя восстановить проходом по блокам
+    uint64_t internal_fragmentation;
+    uint64_t peak_bytes_in_use;
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t free_list_hits;
+    uint64_t bump_allocations;
+    uint64_t failed_allocations;
+    uint64_t size_histogram[FixedMemoryStats::kHistogramBuckets];
+
+    // Сумма записанных частей участков и сумма заголовка (с нулём в этом поле) и таблицы
+    uint64_t data_checksum;
+    uint64_t header_checksum;
+};
+
+struct SnapshotChunk {
+    uint64_t origin;        // адрес участка в сохранившем процессе
+    uint64_t size;          // полный размер участка
+    uint64_t written;       // сколько байт от начала участка записано (дальше - нули)
+    uint64_t file_offset;
+};
+
+// FNV-1a по 8-байтовым словам (хвост - побайтно): снимки большие, побайтная сумма заметно дольше
+constexpr uint64_t kChecksumSeed = 0xcbf29ce484222325;
+
+uint64_t checksum(uint64_t hash, const void* data, size_t size) {
+    constexpr uint64_t kPrime = 0x100000001b3;
+    const char* bytes = static_cast<const char*>(data);
+    size_t words = size / sizeof(uint64_t);
+    for (size_t index = 0; index < words; ++index) {
+        uint64_t word;
+        std::memcpy(&word, bytes + index * sizeof(uint64_t), sizeof(uint64_t));
+        hash = (hash ^ word) * kPrime;
+    }
+    for (size_t index = words * sizeof(uint64_t); index < size; ++index) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[index])) * kPrime;
+    }
+    return hash;
+}
+
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+// Копирование без проверок AddressSanitizer (побайтно через volatile,
+// чтобы компилятор не заменил цикл перехватываемым memcpy)
+__attribute__((no_sanitize_address))
+void copy_unchecked(char* out, const char* in, size_t size) {
+    const volatile char* source = in;
+    for (size_t index = 0; index < size; ++index) {
+        out[index] = source[index];
+    }
+}
+#endif
+
+// Запись части участка с подсчётом суммы
+// Под AddressSanitizer - через промежуточный буфер: хвосты занятых блоков
+// и данные свободных помечены недоступными
+void write_chunk(std::ofstream& file, const char* data, size_t size, uint64_t& hash) {
+#ifdef FIXED_MEMORY_RESOURCE_ASAN
+    std::vector<char> buffer(std::min<size_t>(size, 64 * 1024));
+    for (size_t done = 0; done < size; done += buffer.size()) {
+        size_t part = std::min(buffer.size(), size - done);
+        copy_unchecked(buffer.data(), data + done, part);
+        hash = checksum(hash, buffer.data(), part);
+        file.write(buffer.data(), static_cast<std::streamsize>(part));
+    }
+#else
+    hash = checksum(hash, data, size);
+    file.write(data, static_cast<std::streamsize>(size));
+#endif
+}
+
+uint64_t header_checksum(SnapshotHeader header, const SnapshotChunk* table) {
+    header.header_checksum = 0;
+    uint64_t hash = checksum(kChecksumSeed, &header, sizeof(header));
+    return checksum(hash, table, header.chunk_count * sizeof(SnapshotChunk));
+}
+
+[[noreturn]] void throw_damaged(const std::string& path) {
+    throw std::runtime_error("Pool snapshot " + path + " is damaged");
+}
+
+}
+
+// Снимок: размеченные части участков пишутся как есть, неразмеченные остатки - дырами в файле
+// Списки свободных не сохраняются - загрузка строит их заново по заголовкам блоков
+void FixedMemoryResource::save_snapshot(const std::string& path, const void* root) const {
+    if (!memory_pool_) {
+        throw std::runtime_error("Cannot snapshot a moved-from pool");
+    }
+    if (marker_depth_ != 0) {
+        throw std::runtime_error("Cannot snapshot a pool with active markers");
+    }
+    size_t root_chunk = root ? chunk_index_of(root) : chunk_count_;
+    if (root && root_chunk == chunk_count_) {
+        throw std::invalid_argument("Snapshot root is not allocated by this resource");
+    }
+
+    SnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.block_header_size = kHeaderSize;
+    header.block_alignment = kBlockAlignment;
+    header.guard_size = kGuardSize;
+    header.strategy = static_cast<uint32_t>(strategy_);
+    header.fence_reserved = pool_size_ < chunks_[chunk_count_ - 1].size ? 1 : 0;
+    header.growth_factor = growth_factor_;
+    header.max_total_size = max_total_size_;
+    header.chunk_count = chunk_count_;
+    header.current_offset = current_offset_;
+    header.top_prev_size = top_prev_size_;
+    header.root_chunk = root ? root_chunk : kNoSnapshotRoot;
+    header.root_offset = root ? static_cast<uint64_t>(static_cast<const char*>(root) -
+                                                       static_cast<const char*>(chunks_[root_chunk].memory))
+                              : 0;
+    header.internal_fragmentation = internal_fragmentation_;
+    header.peak_bytes_in_use = peak_bytes_in_use_;
+    header.allocations = allocations_;
+    header.deallocations = deallocations_;
+    header.free_list_hits = free_list_hits_;
+    header.bump_allocations = bump_allocations_;
+    header.failed_allocations = failed_allocations_;
+    for (size_t bucket = 0; bucket < FixedMemoryStats::kHistogramBuckets; ++bucket) {
+        header.size_histogram[bucket] = size_histogram_[bucket];
+    }
+
+    // Закрытые участки записываются вместе с заграждением, текущий - до вершины
+    SnapshotChunk table[kMaxChunks];
+    size_t file_offset = align_up(sizeof(header) + chunk_count_ * sizeof(SnapshotChunk), kSnapshotAlignment);
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        const Chunk& chunk = chunks_[index];
+        table[index].origin = reinterpret_cast<uintptr_t>(chunk.memory);
+        table[index].size = chunk.size;
+        table[index].written = index + 1 == chunk_count_ ? current_offset_ : chunk.used + kHeaderSize;
+        table[index].file_offset = file_offset;
+        file_offset = align_up(file_offset + chunk.size, kSnapshotAlignment);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open snapshot file " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table), static_cast<std::streamsize>(chunk_count_ * sizeof(SnapshotChunk)));
+
+    uint64_t hash = kChecksumSeed;
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        file.seekp(static_cast<std::streamoff>(table[index].file_offset));
+        write_chunk(file, static_cast<const char*>(chunks_[index].memory), table[index].written, hash);
+    }
+
+    // Файл должен покрывать последний участок целиком, иначе его не отобразить
+    const SnapshotChunk& last = table[chunk_count_ - 1];
+    if (last.written < last.size) {
+        file.seekp(static_cast<std::streamoff>(last.file_offset + last.size - 1));
+        file.put('\0');
+    }
+
+    header.data_checksum = hash;
+    header.header_checksum = header_checksum(header, table);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Cannot write snapshot file " + path);
+    }
+}
+
+FixedMemoryResource FixedMemoryResource::load_snapshot(const std::string& path,
+                                                       std::pmr::memory_resource* upstream) {
+#if FIXED_MEMORY_RESOURCE_MADVISE
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open snapshot file " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        throw_damaged(path);
+    }
+    size_t file_size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot file " + path);
+    }
+
+    // Отображение переходит пулу после проверок, до этого снимается при ошибке
+    struct MappingGuard {
+        void* memory;
+        size_t size;
+        ~MappingGuard() {
+            if (memory) {
+                munmap(memory, size);
+            }
+        }
+    } guard{mapping, file_size};
+
+    char* base = static_cast<char*>(mapping);
+    const auto& header = *reinterpret_cast<const SnapshotHeader*>(base);
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion) {
+        throw std::runtime_error(path + " is not a pool snapshot");
+    }
+    if (header.block_header_size != kHeaderSize || header.block_alignment != kBlockAlignment ||
+        header.guard_size != kGuardSize) {
+        throw std::runtime_error("Pool snapshot " + path + " was saved by a build with a different block layout");
+    }
+    if (header.chunk_count == 0 || header.chunk_count > kMaxChunks ||
+        sizeof(header) + header.chunk_count * sizeof(SnapshotChunk) > file_size) {
+        throw_damaged(path);
+    }
+    const auto* table = reinterpret_cast<const SnapshotChunk*>(base + sizeof(header));
+    if (header.header_checksum != header_checksum(header, table)) {
+        throw_damaged(path);
+    }
+
+    uint64_t hash = kChecksumSeed;
+    for (size_t index = 0; index < header.chunk_count; ++index) {
+        const SnapshotChunk& chunk = table[index];
+        if (chunk.file_offset % kSnapshotAlignment != 0 || chunk.size < kMinBlockSize + kHeaderSize ||
+            chunk.file_offset > file_size || chunk.size > file_size - chunk.file_offset ||
+            chunk.written > chunk.size || (index + 1 != header.chunk_count && chunk.written < kHeaderSize)) {
+            throw_damaged(path);
+        }
+        hash = checksum(hash, base + chunk.file_offset, chunk.written);
+    }
+    const SnapshotChunk& last = table[header.chunk_count - 1];
+    size_t reserve = header.fence_reserved ? kHeaderSize : 0;
+    if (hash != header.data_checksum || header.current_offset != last.written ||
+        header.current_offset > last.size - reserve ||
+        (header.root_chunk != kNoSnapshotRoot &&
+         (header.root_chunk >= header.chunk_count || header.root_offset >= table[header.root_chunk].size))) {
+        throw_damaged(path);
+    }
+    if (upstream && !header.fence_reserved) {
+        throw std::invalid_argument("Snapshot of a fixed-size pool cannot grow");
+    }
+
+    // Первый участок передаётся как внешний буфер, остальное состояние - напрямую
+    FixedMemoryResourceOptions options;
+    options.initial_size = table[0].size;
+    options.strategy = static_cast<AllocationStrategy>(header.strategy);
+    options.upstream = upstream;
+    options.growth_factor = header.growth_factor;
+    options.max_total_size = header.max_total_size;
+    options.buffer = base + table[0].file_offset;
+    FixedMemoryResource memory(options);
+
+    memory.snapshot_mapping_ = mapping;
+    memory.snapshot_mapping_size_ = file_size;
+    guard.memory = nullptr;
+
+    memory.chunk_count_ = header.chunk_count;
+    memory.external_chunks_ = header.chunk_count;
+    memory.total_size_ = 0;
+    for (size_t index = 0; index < header.chunk_count; ++index) {
+        const SnapshotChunk& chunk = table[index];
+        bool closed = index + 1 != header.chunk_count;
+        memory.chunks_[index] = {base + chunk.file_offset, chunk.size, closed ? chunk.written - kHeaderSize : 0,
+                                 reinterpret_cast<const void*>(chunk.origin)};
+        memory.total_size_ += chunk.size;
+    }
+    memory.memory_pool_ = memory.chunks_[header.chunk_count - 1].memory;
+    memory.pool_size_ = last.size - reserve;
+    memory.current_offset_ = header.current_offset;
+    memory.top_prev_size_ = header.top_prev_size;
+    memory.internal_fragmentation_ = header.internal_fragmentation;
+    memory.peak_bytes_in_use_ = header.peak_bytes_in_use;
+    memory.allocations_ = header.allocations;
+    memory.deallocations_ = header.deallocations;
+    memory.free_list_hits_ = header.free_list_hits;
+    memory.bump_allocations_ = header.bump_allocations;
+    memory.failed_allocations_ = header.failed_allocations;
+    for (size_t bucket = 0; bucket < FixedMemoryStats::kHistogramBuckets; ++bucket) {
+        memory.size_histogram_[bucket] = header.size_histogram[bucket];
+    }
+    if (header.root_chunk != kNoSnapshotRoot) {
+        memory.snapshot_root_ = static_cast<char*>(memory.chunks_[header.root_chunk].memory) + header.root_offset;
+    }
+
+    try {
+        memory.rebuild_from_blocks();
+    } catch (const std::runtime_error&) {
+        throw_damaged(path);
+    }
+    return memory;
+#else
+    (void)path;
+    (void)upstream;
+    throw std::runtime_error("Pool snapshots are not supported on this platform");
+#endif
+}
+
+void* FixedMemoryResource::relocate(const void* saved) const {
+    if (!saved) {
+        return nullptr;
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(saved);
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        uintptr_t origin = reinterpret_cast<uintptr_t>(chunks_[index].origin);
+        if (address >= origin && address - origin < chunks_[index].size) {
+            return static_cast<char*>(chunks_[index].memory) + (address - origin);
+        }
+    }
+    throw std::invalid_argument("Address does not belong to the snapshot pool");
+}
+
+// Принадлежность указателя пулу
+bool FixedMemoryResource::owns(const void* ptr) const {
+    return chunk_index_of(ptr) != chunk_count_;
+}
+
+// Свободная память: блоки в списках плюс ещё не размеченный остаток пула
+size_t FixedMemoryResource::get_free_bytes() const {
+    return free_bytes_ + (pool_size_ - current_offset_);
+}
+
+// Самый большой непрерывный свободный участок
+size_t FixedMemoryResource::get_largest_free_block() const {
+    // Блок перед вершиной пула всегда занят (свободный поглощается вершиной),
+    // поэтому остаток пула - самостоятельный непрерывный участок
+    size_t largest = pool_size_ - current_offset_;
+    if (first_level_bitmap_ != 0) {
+        // Самые большие блоки лежат в старшем непустом классе,
+        // внутри класса размеры различаются, поэтому просматриваем список
+        size_t first = floor_log2(first_level_bitmap_);
+        size_t second = floor_log2(second_level_bitmaps_[first]);
+        for (const FreeNode* node = free_lists_[first][second]; node; node = node->next) {
+            largest = std::max(largest, block_size(header_of(node)));
+        }
+    }
+    return largest;
+}
+
+// Внешняя фрагментация: 1 - (наибольший свободный участок / вся свободная память)
+// 0 - вся свободная память непрерывна, близко к 1 - она раздроблена на мелкие куски
+double FixedMemoryResource::get_fragmentation() const {
+    size_t free_bytes = get_free_bytes();
+    if (free_bytes == 0) {
+        return 0.0;
+    }
+    return 1.0 - static_cast<double>(get_largest_free_block()) / static_cast<double>(free_bytes);
+}
+
+// Поиск свободного блока для переиспользования
+FixedMemoryResource::BlockHeader* FixedMemoryResource::find_free_block(size_t size,
+                                                                       size_t alignment) {
+    // Блок подходит, если в нём помещается выровненный блок размера size
+    // (с учётом отступа, который понадобится для выравнивания данных)
+    auto fits = [size, alignment](const BlockHeader* header) {
+        return aligned_lead(header, alignment) + size <= block_size(header);
+    };
+
+    // Сначала голова собственного списка: для точных классов подходит любой блок,
+    // для остальных достаточно одной проверки размера
+    ListIndex own = list_index_of(size);
+    FreeNode* head = free_lists_[own.first][own.second];
+    if (head && fits(header_of(head))) {
+        remove_free_block(header_of(head));
+        return header_of(head);
+    }
+
+    // При повышенном выравнивании ищем блок с запасом под максимальный отступ,
+    // тогда любой найденный блок гарантированно подходит
+    size_t search_size = alignment > kBlockAlignment ? size + alignment + kMinBlockSize : size;
+    ListIndex index = list_index_of(search_size);
+
+    if (strategy_ == AllocationStrategy::Tlsf) {
+        // Округляем запрос вверх до границы подкласса: все блоки найденного
+        // списка не меньше search_size, голову берём без просмотра списка
+        if (search_size >= kSmallBlockLimit) {
+            size_t step = size_t{1} << (floor_log2(search_size) - kSecondLevelLog2);
+            index = list_index_of(search_size + step - 1);
+        }
+    } else {
+        // Любой блок из следующих непустых классов заведомо больше search_size
+        ++index.second;
+    }
+
+    FreeNode* node = find_non_empty_list(index);
+    if (!node || !fits(header_of(node))) {
+        // Подходящий блок не найден (второе условие срабатывает только для
+        // запросов крупнее последнего класса)
+        return nullptr;
+    }
+    remove_free_block(header_of(node));
+    return header_of(node);
+}
+
+// Первый непустой список не меньше index: сначала в той же строке второго уровня,
+// затем в следующих строках первого уровня - две операции поиска бита
+FixedMemoryResource::FreeNode* FixedMemoryResource::find_non_empty_list(ListIndex index) const {
+    uint32_t second_map = index.second < kSecondLevelCount
+        ? second_level_bitmaps_[index.first] & (~uint32_t{0} << index.second)
+        : 0;
+    if (second_map == 0) {
+        uint64_t first_map = index.first + 1 < kFirstLevelCount
+            ? first_level_bitmap_ & (~uint64_t{0} << (index.first + 1))
+            : 0;
+        if (first_map == 0) {
+            return nullptr;
+        }
+        index.first = lowest_bit(first_map);
+        second_map = second_level_bitmaps_[index.first];
+    }
+    return free_lists_[index.first][lowest_bit(second_map)];
+}
+
+// Размещение выровненного блока размера size внутри свободного блока header
+// Отступ перед выровненными данными и лишний хвост возвращаются в пул
+void* FixedMemoryResource::place_block(BlockHeader* header, size_t size, size_t alignment) {
+    size_t lead = aligned_lead(header, alignment);
+    if (lead != 0) {
+        // Отступ остаётся свободным блоком: слева от него занятый блок, сливать не с чем
+        size_t total = block_size(header);
+        auto* block = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(header) + lead);
+        header->size = lead | depth_bits();
+        block->prev_size = lead;
+        block->size = (total - lead) | depth_bits();
+        set_next_prev_size(reinterpret_cast<char*>(block) + total - lead, total - lead);
+        push_free_block(header);
+        header = block;
+    }
+
+    split_block(header, size);
+    header->size |= kInUseFlag;
+    return header + 1;
+}
+
+// Отступ от начала блока до блока с выровненными данными
+// Отступ либо нулевой, либо вмещает отдельный свободный блок
+size_t FixedMemoryResource::aligned_lead(const void* block_start, size_t alignment) {
+    if (alignment <= kBlockAlignment) {
+        return 0;
+    }
+    uintptr_t payload = reinterpret_cast<uintptr_t>(block_start) + kHeaderSize;
+    size_t lead = align_up(payload, alignment) - payload;
+    if (lead != 0 && lead < kMinBlockSize) {
+        lead += alignment;
+    }
+    return lead;
+}
+
+// Добавление блока в голову списка его размерного класса
+void FixedMemoryResource::push_free_block(BlockHeader* header) {
+    size_t size = block_size(header);
+    ListIndex index = list_index_of(size);
+    FreeNode*& head = free_lists_[index.first][index.second];
+    auto* node = reinterpret_cast<FreeNode*>(header + 1);
+    node->prev = nullptr;
+    node->next = head;
+    if (node->next) {
+        node->next->prev = node;
+    }
+    head = node;
+    asan_poison(reinterpret_cast<char*>(header) + kMinBlockSize, reinterpret_cast<char*>(header) + size);
+    first_level_bitmap_ |= uint64_t{1} << index.first;
+    second_level_bitmaps_[index.first] |= uint32_t{1} << index.second;
+    ++free_count_;
+    free_bytes_ += size;
+}
+
+// Удаление блока из середины списка за O(1) благодаря ссылке на предыдущий узел
+void FixedMemoryResource::remove_free_block(BlockHeader* header) {
+    size_t size = block_size(header);
+    ListIndex index = list_index_of(size);
+    FreeNode*& head = free_lists_[index.first][index.second];
+    auto* node = reinterpret_cast<FreeNode*>(header + 1);
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        head = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    if (!head) {
+        second_level_bitmaps_[index.first] &= ~(uint32_t{1} << index.second);
+        if (second_level_bitmaps_[index.first] == 0) {
+            first_level_bitmap_ &= ~(uint64_t{1} << index.first);
+        }
+    }
+    --free_count_;
+    free_bytes_ -= size;
+}
+
+// Освобождение блока со слиянием соседей по адресу (boundary tags)
+// Следующий блок находится по размеру текущего, предыдущий - по prev_size,
+// поэтому два свободных блока никогда не лежат рядом
+// Свободный блок, касающийся вершины пула, поглощается вершиной
+// Участок для этого искать не нужно: у первого блока участка prev_size == 0,
+// а за последним лежит либо вершина (текущий участок), либо заграждение (закрытый)
+void FixedMemoryResource::release_block(BlockHeader* header) {
+    char* start = reinterpret_cast<char*>(header);
+    size_t size = block_size(header);
+    char* pool_top = top();
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    char* freed = start;
+    char* freed_end = start + size;
+    bool merged_next = false;
+#endif
+
+    // Слияние со следующим блоком
+    // Блоки другой глубины лежат по ту сторону границы метки и не сливаются
+    if (start + size != pool_top) {
+        auto* next = reinterpret_cast<BlockHeader*>(start + size);
+        if (!(next->size & kInUseFlag) && depth_of(next) == marker_depth_) {
+            remove_free_block(next);
+            size += block_size(next);
+#if FIXED_MEMORY_RESOURCE_HARDENED
+            merged_next = true;
+#endif
+        }
+    }
+
+    // Слияние с предыдущим блоком (у первого блока prev_size == 0)
+    if (header->prev_size != 0) {
+        auto* prev = reinterpret_cast<BlockHeader*>(start - header->prev_size);
+        if (!(prev->size & kInUseFlag) && depth_of(prev) == marker_depth_) {
+            remove_free_block(prev);
+            start -= header->prev_size;
+            size += header->prev_size;
+            header = prev;
+        }
+    }
+
+    // Блок у вершины пула не попадает в списки свободных:
+    // current_offset_ просто откатывается назад (LIFO-освобождение без работы со списками)
+    // Предыдущий блок к этому моменту занят, иначе он уже слился бы с текущим
+    if (start + size == pool_top) {
+        current_offset_ = static_cast<size_t>(start - static_cast<char*>(memory_pool_));
+        top_prev_size_ = header->prev_size;
+        asan_poison(start, start + size);
+        return;
+    }
+
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    // Заливаем узором данные освобождённого блока и служебные поля поглощённого соседа
+    // Данные соседей уже залиты, когда те освобождались
+    fill_pattern(std::max(freed, start + kMinBlockSize), freed_end, kFreedByte);
+    if (merged_next) {
+        fill_pattern(freed_end, freed_end + kMinBlockSize, kFreedByte);
+    }
+#endif
+
+    header->size = size | depth_bits();
+    set_next_prev_size(start + size, size);
+    push_free_block(header);
+}
+
+// Отрезание хвоста от свободного (ещё не помеченного занятым) блока
+// Хвост возвращается в пул, если из него получается полноценный блок
+void FixedMemoryResource::split_block(BlockHeader* header, size_t size) {
+    size_t remainder = block_size(header) - size;
+    if (remainder < kMinBlockSize) {
+        return;
+    }
+
+    auto* tail = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(header) + size);
+    header->size = size | depth_bits();
+    tail->prev_size = size;
+    tail->size = remainder | depth_bits();
+    set_next_prev_size(reinterpret_cast<char*>(tail) + remainder, remainder);
+
+    // За исходным блоком не может лежать свободный блок, поэтому хвост не сливаем
+    push_free_block(tail);
+}
+
+// Обновление prev_size у блока, начинающегося с адреса end
+void FixedMemoryResource::set_next_prev_size(char* end, size_t size) {
+    if (end == top()) {
+        top_prev_size_ = size;
+    } else {
+        reinterpret_cast<BlockHeader*>(end)->prev_size = size;
+    }
+}
+
+char* FixedMemoryResource::top() const {
+    return static_cast<char*>(memory_pool_) + current_offset_;
+}
+
+// Подключение следующего участка растущего пула
+void FixedMemoryResource::add_chunk(size_t min_size) {
+    if (!upstream_ || chunk_count_ == kMaxChunks) {
+        throw std::bad_alloc();
+    }
+
+    // Геометрический рост, но не меньше, чем нужно запросу (плюс заграждение)
+    size_t size = std::max(chunks_[chunk_count_ - 1].size * growth_factor_,
+                           align_up(min_size + kHeaderSize, kBlockAlignment));
+    if (max_total_size_ != 0) {
+        size_t left = max_total_size_ > total_size_ ? max_total_size_ - total_size_ : 0;
+        size = std::min(size, left & ~(kBlockAlignment - 1));
+        if (size < min_size + kHeaderSize) {
+            throw std::bad_alloc();
+        }
+    }
+    void* memory = upstream_->allocate(size, kBlockAlignment);
+
+    // Закрываем текущий участок: остаток становится свободным блоком
+    // (блок перед вершиной всегда занят, сливать не с чем), за ним ставится заграждение
+    char* fence = top();
+    size_t fence_prev_size = top_prev_size_;
+    size_t remainder = pool_size_ - current_offset_;
+    asan_unpoison(fence, fence + remainder + kHeaderSize);
+    if (remainder >= kMinBlockSize) {
+        auto* tail = reinterpret_cast<BlockHeader*>(fence);
+        tail->prev_size = top_prev_size_;
+        tail->size = remainder | depth_bits();
+#if FIXED_MEMORY_RESOURCE_HARDENED
+        fill_pattern(fence + kMinBlockSize, fence + remainder, kFreedByte);
+#endif
+        push_free_block(tail);
+        fence += remainder;
+        fence_prev_size = remainder;
+    }
+    auto* fence_header = reinterpret_cast<BlockHeader*>(fence);
+    fence_header->prev_size = fence_prev_size;
+    fence_header->size = kInUseFlag | depth_bits();
+    chunks_[chunk_count_ - 1].used = static_cast<size_t>(fence - static_cast<char*>(memory_pool_));
+
+    // Новый участок становится текущим
+    chunks_[chunk_count_++] = {memory, size, 0, memory};
+    asan_poison(memory, static_cast<char*>(memory) + size);
+    total_size_ += size;
+    memory_pool_ = memory;
+    pool_size_ = size - kHeaderSize;
+    current_offset_ = 0;
+    top_prev_size_ = 0;
+}
+
+// Поиск участка перебором: участков мало, и нужен он только для проверок
+size_t FixedMemoryResource::chunk_index_of(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        const char* base = static_cast<const char*>(chunks_[index].memory);
+        if (p >= base && p < base + chunks_[index].size) {
+            return index;
+        }
+    }
+    return chunk_count_;
+}
+
+void FixedMemoryResource::clear_free_lists() {
+    std::fill(&free_lists_[0][0], &free_lists_[0][0] + kFirstLevelCount * kSecondLevelCount, nullptr);
+    std::fill(std::begin(second_level_bitmaps_), std::end(second_level_bitmaps_), 0);
+    first_level_bitmap_ = 0;
+    free_count_ = 0;
+    free_bytes_ = 0;
+}
+
+// Точные классы для маленьких блоков, далее строка по номеру старшего бита размера
+// Для Tlsf следующие kSecondLevelLog2 бит размера выбирают подкласс внутри строки
+FixedMemoryResource::ListIndex FixedMemoryResource::list_index_of(size_t size) const {
+    if (size < kSmallBlockLimit) {
+        return {0, size / kBlockAlignment};
+    }
+    size_t log2 = floor_log2(size);
+    size_t first = log2 - floor_log2(kSmallBlockLimit) + 1;
+    if (first >= kFirstLevelCount) {
+        return {kFirstLevelCount - 1, kSecondLevelCount - 1};
+    }
+    if (strategy_ != AllocationStrategy::Tlsf) {
+        return {first, 0};
+    }
+    return {first, (size >> (log2 - kSecondLevelLog2)) - kSecondLevelCount};
+}
+
+// Проверка освобождаемого блока по его заголовку и соседям
+void FixedMemoryResource::validate_block(const void* ptr, size_t bytes) const {
+    size_t index = chunk_index_of(ptr);
+    if (index == chunk_count_) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+
+    // Граница размеченной части участка: вершина для текущего, заграждение для закрытых
+    const char* base = static_cast<const char*>(chunks_[index].memory);
+    const char* p = static_cast<const char*>(ptr);
+    size_t used = index + 1 == chunk_count_ ? current_offset_ : chunks_[index].used;
+
+    // Указатель должен лежать в занятой части участка и быть началом данных блока
+    if (p < base + kHeaderSize || p >= base + used || (p - base) % kBlockAlignment != 0) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+
+    // Заголовок в помеченной для AddressSanitizer памяти - значит, указатель не на начало данных
+    const BlockHeader* header = header_of(ptr);
+    if (!asan_readable(header, kHeaderSize)) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+    size_t offset = static_cast<size_t>(reinterpret_cast<const char*>(header) - base);
+    size_t size = block_size(header);
+
+    if (!(header->size & kInUseFlag)) {
+        throw std::invalid_argument("Block is already free");
+    }
+
+    // Размер блока и ссылки на соседей должны быть согласованы
+    // Так отсекаются указатели в середину блока и испорченные заголовки
+    bool consistent = size >= kMinBlockSize && offset + size <= used &&
+                      header->prev_size <= offset && bytes <= size - kHeaderSize;
+    if (consistent && offset == 0) {
+        consistent = header->prev_size == 0;
+    } else if (consistent) {
+        auto* prev = reinterpret_cast<const BlockHeader*>(base + offset - header->prev_size);
+        consistent = header->prev_size != 0 && asan_readable(prev, kHeaderSize) &&
+                     block_size(prev) == header->prev_size;
+    }
+    if (consistent && offset + size < used) {
+        auto* next = reinterpret_cast<const BlockHeader*>(base + offset + size);
+        consistent = asan_readable(next, kHeaderSize) && next->prev_size == size;
+    }
+    if (!consistent) {
+        throw std::invalid_argument("Block not allocated by this resource");
+    }
+}
+
+// Блок уже имеет новый размер; выравнивание в трассе - обычное (исходное не хранится)
+void FixedMemoryResource::record_resize(void* ptr, size_t old_size, size_t old_bytes, size_t new_bytes) {
+    size_t new_size = block_size(header_of(ptr));
+    internal_fragmentation_ -= old_size - kHeaderSize - old_bytes;
+    internal_fragmentation_ += new_size - kHeaderSize - new_bytes;
+    bytes_in_use_ -= old_size;
+    bytes_in_use_ += new_size;
+    peak_bytes_in_use_.raise_to(bytes_in_use_);
+    if (trace_) {
+        trace_->record(TraceOp::Deallocate, old_bytes, kBlockAlignment, ptr);
+        trace_->record(TraceOp::Allocate, new_bytes, kBlockAlignment, ptr, depth_of(header_of(ptr)));
+    }
+}
+
+// Хвост блока за запрошенными байтами: в усиленном режиме - контрольные байты,
+// под AddressSanitizer он недоступен, пока блок занят
+void FixedMemoryResource::guard_block(void* ptr, size_t bytes) {
+    char* data_end = static_cast<char*>(ptr) + bytes;
+    char* block_end = reinterpret_cast<char*>(header_of(ptr)) + block_size(header_of(ptr));
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    fill_pattern(data_end, block_end, kGuardByte);
+#endif
+    asan_poison(data_end, block_end);
+}
+
+void FixedMemoryResource::check_guard(void* ptr, size_t bytes) {
+    char* data_end = static_cast<char*>(ptr) + bytes;
+    char* block_end = reinterpret_cast<char*>(header_of(ptr)) + block_size(header_of(ptr));
+    asan_unpoison(data_end, block_end);
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    if (!has_pattern(data_end, block_end, kGuardByte)) {
+        throw std::runtime_error("Buffer overflow past the end of a block");
+    }
+#endif
+}
+
+#if FIXED_MEMORY_RESOURCE_HARDENED
+// Узор лежит в данных за узлом списка; блок уже вынут из списка, поэтому при ошибке
+// возвращаем его обратно, чтобы пул остался согласованным
+void FixedMemoryResource::check_freed(BlockHeader* header) {
+    char* block = reinterpret_cast<char*>(header);
+    if (!has_pattern(block + kMinBlockSize, block + block_size(header), kFreedByte)) {
+        push_free_block(header);
+        throw std::runtime_error("Freed block was written after deallocation");
+    }
+}
+#endif
+
+// Заголовок лежит непосредственно перед данными пользователя
+FixedMemoryResource::BlockHeader* FixedMemoryResource::header_of(void* ptr) {
+    return static_cast<BlockHeader*>(ptr) - 1;
+}
+
+const FixedMemoryResource::BlockHeader* FixedMemoryResource::header_of(const void* ptr) {
+    return static_cast<const BlockHeader*>(ptr) - 1;
+}
+
+size_t FixedMemoryResource::block_size(const BlockHeader* header) {
+    return header->size & kSizeMask;
+}
+
+size_t FixedMemoryResource::depth_of(const BlockHeader* header) {
+    return header->size >> kDepthShift;
+}
+
+size_t FixedMemoryResource::depth_bits() const {
+    return marker_depth_ << kDepthShift;
+}
+
+// Блок помечается свободным (так повторное освобождение обнаруживается проверкой),
+// но в списки не попадает и ни с кем не сливается
+void FixedMemoryResource::defer_release(BlockHeader* header, size_t fragmentation) {
+    header->size &= ~kInUseFlag;
+    auto* node = reinterpret_cast<DeferredNode*>(header + 1);
+    node->next = deferred_;
+    node->fragmentation = fragmentation;
+    deferred_ = node;
+    ++deferred_count_;
+    deferred_fragmentation_ += fragmentation;
+}
+
+// Очистка ресурсов
+void FixedMemoryResource::cleanup() {
+    if (memory_pool_) {
+        // Если остались неосвобождённые блоки - выводим предупреждение
+        if (allocated_count_ != 0) {
+            std::cout << "Внимание: освобождается память с "
+                      << allocated_count_ << " неосвобождёнными блоками\n";
+        }
+
+        // Освобождаем все участки туда, откуда они были взяты
+        for (size_t index = 0; index < chunk_count_; ++index) {
+            free_chunk(index);
+        }
+#if FIXED_MEMORY_RESOURCE_MADVISE
+        if (snapshot_mapping_) {
+            munmap(snapshot_mapping_, snapshot_mapping_size_);
+            snapshot_mapping_ = nullptr;
+        }
+#endif
+        memory_pool_ = nullptr;
+        chunk_count_ = 0;
+    }
+}
+
+// Внешние участки (буфер вызывающего, отображение снимка) остаются на месте
+void FixedMemoryResource::free_chunk(size_t index) {
+    asan_unpoison(chunks_[index].memory, static_cast<char*>(chunks_[index].memory) + chunks_[index].size);
+    if (index < external_chunks_) {
+        return;
+    }
+    if (upstream_) {
+        upstream_->deallocate(chunks_[index].memory, chunks_[index].size, kBlockAlignment);
+    } else {
+        ::operator delete(chunks_[index].memory);
+    }
+}
+
+// Проход по блокам всех участков: свободные блоки попадают в списки, занятые - в счётчики
+// Заодно проверяется, что заголовки образуют непрерывную цепочку до вершины или заграждения
+void FixedMemoryResource::rebuild_from_blocks() {
+    size_t allocated = 0;
+    size_t in_use = 0;
+    clear_free_lists();
+    for (size_t index = 0; index < chunk_count_; ++index) {
+        char* start = static_cast<char*>(chunks_[index].memory);
+        bool current = index + 1 == chunk_count_;
+        size_t end = current ? current_offset_ : chunks_[index].used;
+        asan_unpoison(start, start + chunks_[index].size);
+
+        size_t offset = 0;
+        size_t prev_size = 0;
+        while (offset < end) {
+            auto* header = reinterpret_cast<BlockHeader*>(start + offset);
+            size_t size = block_size(header);
+            if (header->prev_size != prev_size || size < kMinBlockSize || size > end - offset ||
+                depth_of(header) != 0) {
+                throw std::runtime_error("Broken block chain");
+            }
+            if (header->size & kInUseFlag) {
+                ++allocated;
+                in_use += size;
+            } else {
+                push_free_block(header);
+            }
+            prev_size = size;
+            offset += size;
+        }
+
+        if (current) {
+            if (prev_size != top_prev_size_) {
+                throw std::runtime_error("Broken block chain");
+            }
+            asan_poison(start + end, start + chunks_[index].size);
+        } else {
+            auto* fence = reinterpret_cast<const BlockHeader*>(start + end);
+            if (fence->size != kInUseFlag || fence->prev_size != prev_size) {
+                throw std::runtime_error("Broken block chain");
+            }
+        }
+    }
+    allocated_count_ = allocated;
+    bytes_in_use_ = in_use;
 }
\ No newline at end of file
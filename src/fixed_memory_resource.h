@@ -1,78 +1,633 @@
-#ifndef FIXED_MEMORY_RESOURCE_H
-#define FIXED_MEMORY_RESOURCE_H
-
-#include <memory_resource>
-#include <map>
-#include <cstddef>
-
-// Аллокатор с фиксированным блоком памяти
-// Выделяет память один раз при создании, затем управляет этим блоком
-class FixedMemoryResource : public std::pmr::memory_resource {
-private:
-    // Указатель на начало фиксированного блока памяти
-    void* memory_pool_;
-    
-    // Общий размер блока памяти в байтах
-    size_t pool_size_;
-    
-    // Текущее смещение в блоке (до какого места выделена память)
-    size_t current_offset_;
-    
-    // Список активных (занятых) блоков: адрес блока -> размер блока
-    // информация о выделенных блоках хранится в std::map
-    std::map<void*, size_t> allocated_blocks_;
-    
-    // Список свободных блоков для переиспользования: размер -> адрес
-    // Используется multimap, так как может быть несколько блоков одного размера
-    std::multimap<size_t, void*> free_blocks_;
-
-public:
-    // Конструктор: выделяет фиксированный блок памяти заданного размера
-    // size - размер блока в байтах (по умолчанию 1 МБ)
-    explicit FixedMemoryResource(size_t size = 1024 * 1024);
-    
-    // Деструктор: освобождает весь блок памяти
-    ~FixedMemoryResource() override;
-    
-    // Запрещаем копирование (уникальныйй ресурс
-    FixedMemoryResource(const FixedMemoryResource&) = delete; //коп
-    FixedMemoryResource& operator=(const FixedMemoryResource&) = delete; //при коп
-    
-    // Разрешаем перемещение (передача владения)
-    FixedMemoryResource(FixedMemoryResource&& other) noexcept; //пер
-    FixedMemoryResource& operator=(FixedMemoryResource&& other) noexcept; //присв пер
-    
-    // Вывод статистики использования памяти
-    void print_stats() const;
-    
-    // Методы для тестирования
-    size_t get_allocated_count() const { return allocated_blocks_.size(); }
-    size_t get_free_count() const { return free_blocks_.size(); }
-    size_t get_current_offset() const { return current_offset_; }
-
-protected:
-    // Выделение памяти (переопределение виртуального метода базового класса)
-    // bytes - количество байт для выделения
-    // alignment - требуемое выравнивание адреса
-    void* do_allocate(size_t bytes, size_t alignment) override;
-    
-    // Освобождение памяти (переопределение виртуального метода базового класса)
-    // ptr - указатель на освобождаемый блок
-    // bytes - размер блока
-    // alignment - выравнивание блока
-    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
-    
-    // Сравнение memory_resource (переопределение виртуального метода)
-    // Два ресурса равны, если это один и тот же объект
-    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
-
-private:
-    // Поиск подходящего свободного блока для переиспользования
-    // Возвращает указатель на блок или nullptr, если подходящий не найден
-    void* find_free_block(size_t bytes, size_t alignment);
-    
-    // Очистка всех ресурсов (вызывается в деструкторе)
-    void cleanup();
-};
-
+#ifndef FIXED_MEMORY_RESOURCE_H
+#define FIXED_MEMORY_RESOURCE_H
+
+#include "stat_counter.h"
+#include <memory_resource>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Проверка освобождаемых указателей (чужой указатель, двойное освобождение,
+// повреждённый заголовок). Включена по умолчанию, отключается опцией CMake
+// LAB05_CHECKED_DEALLOCATE=OFF - тогда do_deallocate работает без проверок
+#ifndef FIXED_MEMORY_RESOURCE_CHECKED
+#define FIXED_MEMORY_RESOURCE_CHECKED 1
+#endif
+
+// Гистограммы задержек do_allocate/do_deallocate в тактах процессора
+// Выключены по умолчанию, включаются опцией CMake LAB05_LATENCY_HISTOGRAM=ON
+// В выключенном виде не добавляют ни полей, ни инструкций
+#ifndef FIXED_MEMORY_RESOURCE_LATENCY
+#define FIXED_MEMORY_RESOURCE_LATENCY 0
+#endif
+
+// Усиленные проверки для отладочных сборок и стендов (включены в Debug и опцией CMake
+// LAB05_HARDENED=ON): за данными каждого блока - контрольные байты, которые проверяются
+// при освобождении (запись за конец блока), освобождённые данные заливаются узором,
+// который проверяется при повторном выделении (запись после освобождения)
+// Под AddressSanitizer свободная память пула дополнительно помечается недоступной
+// В выключенном виде проверки не компилируются, размер блоков не меняется
+#ifndef FIXED_MEMORY_RESOURCE_HARDENED
+#define FIXED_MEMORY_RESOURCE_HARDENED 0
+#endif
+
+#if FIXED_MEMORY_RESOURCE_HARDENED && !FIXED_MEMORY_RESOURCE_CHECKED
+#error "FIXED_MEMORY_RESOURCE_HARDENED requires FIXED_MEMORY_RESOURCE_CHECKED"
+#endif
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+#include "latency_histogram.h"
+#endif
+
+// Стратегия поиска свободных блоков в FixedMemoryResource
+enum class AllocationStrategy {
+    // Сегрегированные списки: точные классы для маленьких блоков,
+    // классы-степени двойки для больших (первый подходящий по размеру)
+    SegregatedFit,
+
+    // TLSF (two-level segregated fit): каждый класс-степень двойки дополнительно
+    // делится на 16 подклассов, запрос округляется вверх до подкласса,
+    // поэтому любой блок найденного списка подходит - поиск за O(1) без просмотра списков
+    Tlsf
+};
+
+// Способ возврата страниц системе в FixedMemoryResource::trim
+enum class TrimAdvice {
+    // MADV_DONTNEED: страницы освобождаются сразу, RSS уменьшается немедленно
+    DontNeed,
+
+    // MADV_FREE: ядро забирает страницы лениво, при нехватке памяти
+    // Дешевле, если память скоро понадобится снова, но RSS падает не сразу
+    Free
+};
+
+// Параметры FixedMemoryResource
+struct FixedMemoryResourceOptions {
+    // Размер первого участка пула в байтах
+    size_t initial_size = 1024 * 1024;
+
+    // Стратегия поиска свободных блоков
+    AllocationStrategy strategy = AllocationStrategy::SegregatedFit;
+
+    // Источник памяти для участков пула
+    // nullptr - пул фиксированный: один участок из operator new, при исчерпании std::bad_alloc
+    // Иначе при исчерпании текущего участка у upstream запрашивается следующий
+    std::pmr::memory_resource* upstream = nullptr;
+
+    // Во сколько раз следующий участок больше предыдущего
+    size_t growth_factor = 2;
+
+    // Предел суммарного размера всех участков (0 - без предела)
+    size_t max_total_size = 0;
+
+    // Память первого участка (initial_size байт, адрес кратен 16), которой владеет вызывающий
+    // nullptr - первый участок берётся у operator new или upstream
+    // Ресурс эту память не освобождает; она должна жить дольше ресурса
+    void* buffer = nullptr;
+};
+
+class TraceRecorder;
+
+// Снимок статистики FixedMemoryResource (см. FixedMemoryResource::stats)
+struct FixedMemoryStats {
+    // Гистограмма размеров запросов: корзина i - запросы до 2^(i+4) байт,
+    // последняя корзина - все запросы больше 2^(kHistogramBuckets+2) байт
+    static constexpr size_t kHistogramBuckets = 16;
+
+    // Память пула под занятыми блоками (вместе с заголовками) и её максимум за всё время
+    size_t bytes_in_use;
+    size_t peak_bytes_in_use;
+
+    // Вызовы allocate и deallocate
+    size_t allocations;
+    size_t deallocations;
+
+    // Чем обслужено выделение: блок из списков свободных или сдвиг вершины пула
+    size_t free_list_hits;
+    size_t bump_allocations;
+
+    // Выделения, закончившиеся std::bad_alloc
+    size_t failed_allocations;
+
+    // Внутренняя фрагментация в байтах (как get_internal_fragmentation)
+    size_t internal_fragmentation;
+
+    // Внешняя фрагментация по счётчикам: доля свободной памяти, которая раздроблена
+    // на блоки в списках свободных, а не лежит в неразмеченном остатке участков
+    // В отличие от get_fragmentation не просматривает списки, зато завышает оценку,
+    // если в списках лежат большие блоки
+    double external_fragmentation;
+
+    size_t size_histogram[kHistogramBuckets];
+};
+
+// Аллокатор с фиксированным блоком памяти
+// Выделяет память один раз при создании, затем управляет этим блоком
+// С заданным upstream пул растёт цепочкой участков (см. FixedMemoryResourceOptions)
+class FixedMemoryResource : public std::pmr::memory_resource {
+private:
+    // Служебный заголовок блока, хранится в самом пуле перед данными пользователя
+    // Благодаря ему освобождение работает за O(1) и без обращений к глобальной куче
+    struct BlockHeader {
+        size_t prev_size;   // размер предыдущего блока в пуле (0 для первого блока)
+        size_t size;        // размер блока вместе с заголовком, младшие биты - флаги
+    };
+
+    // Все блоки начинаются с адресов, кратных kBlockAlignment
+    static constexpr size_t kBlockAlignment = 16;
+    static constexpr size_t kHeaderSize = sizeof(BlockHeader);
+
+    // Минимальный размер блока: заголовок + место под служебные данные свободного блока
+    static constexpr size_t kMinBlockSize = 2 * kHeaderSize;
+
+    // Контрольные байты за данными пользователя (только в усиленном режиме)
+    static constexpr size_t kGuardSize = FIXED_MEMORY_RESOURCE_HARDENED ? 8 : 0;
+
+    // Флаг "блок занят" в поле size заголовка
+    static constexpr size_t kInUseFlag = 1;
+    static constexpr size_t kFlagsMask = kBlockAlignment - 1;
+
+    // Старшие биты поля size - глубина метки, при которой блок создан (см. mark)
+    // Блоки разной глубины никогда не сливаются, поэтому граница метки остаётся границей блоков
+    static constexpr size_t kDepthShift = 48;
+    static constexpr size_t kSizeMask = ((size_t{1} << kDepthShift) - 1) & ~kFlagsMask;
+
+    // Наибольший запрос: полный размер блока после округления должен поместиться в kSizeMask
+    // (иначе размер переполнится или заденет биты глубины)
+    static constexpr size_t kMaxRequestSize = kSizeMask - kHeaderSize - kGuardSize - kBlockAlignment;
+
+    // Узел интрусивного двусвязного списка свободных блоков
+    // Лежит в области данных свободного блока, поэтому не требует отдельной памяти
+    // Ссылка на предыдущий узел нужна, чтобы при слиянии вынимать соседа из списка за O(1)
+    struct FreeNode {
+        FreeNode* next;
+        FreeNode* prev;
+    };
+
+    // Двухуровневая сетка списков свободных блоков:
+    // первый уровень 0 - точные классы с шагом kBlockAlignment до kSmallBlockLimit,
+    // первый уровень k > 0 - блоки размером [2^(k+7), 2^(k+8)),
+    // второй уровень делит такой диапазон на kSecondLevelCount равных частей (только Tlsf)
+    static constexpr size_t kSmallBlockLimit = 256;
+    static constexpr size_t kSecondLevelLog2 = 4;
+    static constexpr size_t kSecondLevelCount = size_t{1} << kSecondLevelLog2;
+    static constexpr size_t kFirstLevelCount = 41;
+
+    // Положение списка в сетке
+    struct ListIndex {
+        size_t first;
+        size_t second;
+    };
+
+    // Участок пула
+    // В растущем пуле последние kHeaderSize байт участка зарезервированы под заграждение -
+    // заголовок занятого блока нулевого размера, который ставится при закрытии участка,
+    // поэтому блоки закрытого участка не сливаются через его границу
+    struct Chunk {
+        void* memory;   // начало участка
+        size_t size;    // полный размер участка
+        size_t used;    // граница размеченной части (заграждение) для закрытых участков
+        // Адрес участка в процессе, сохранившем снимок (см. relocate); для своих участков - memory
+        const void* origin;
+    };
+
+    // Участков не больше kMaxChunks: при геометрическом росте этого хватает с запасом
+    static constexpr size_t kMaxChunks = 48;
+
+    // Указатель на начало текущего участка пула (из него идёт выделение со сдвигом смещения)
+    void* memory_pool_;
+
+    // Размер текущего участка в байтах (без заграждения)
+    size_t pool_size_;
+
+    // Текущее смещение в блоке (до какого места выделена память)
+    size_t current_offset_;
+
+    // Размер последнего блока перед current_offset_ (prev_size для следующего блока)
+    size_t top_prev_size_;
+
+    // Счётчики статистики можно читать из других потоков без блокировок (см. stats)
+
+    // Количество активных (занятых) блоков
+    StatCounter allocated_count_;
+
+    // Внутренняя фрагментация: байты в занятых блоках сверх запрошенных
+    // (округление размера и хвосты, которые слишком малы для отдельного блока)
+    StatCounter internal_fragmentation_;
+
+    // Память под занятыми блоками и её максимум
+    StatCounter bytes_in_use_;
+    StatCounter peak_bytes_in_use_;
+
+    // Счётчики вызовов и путей выделения (только растут)
+    StatCounter allocations_;
+    StatCounter deallocations_;
+    StatCounter free_list_hits_;
+    StatCounter bump_allocations_;
+    StatCounter failed_allocations_;
+    StatCounter size_histogram_[FixedMemoryStats::kHistogramBuckets];
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    // Задержки do_allocate и do_deallocate
+    LatencyHistogram allocate_latency_;
+    LatencyHistogram deallocate_latency_;
+#endif
+
+    // Стратегия поиска свободных блоков
+    AllocationStrategy strategy_;
+
+    // Списки свободных блоков для переиспользования, по одному на размерный класс
+    FreeNode* free_lists_[kFirstLevelCount][kSecondLevelCount];
+
+    // Битовые карты непустых списков: бит i в first_level_bitmap_ - есть непустые
+    // списки в строке i, бит j в second_level_bitmaps_[i] - список [i][j] не пуст
+    // Позволяют найти ближайший подходящий класс за O(1)
+    uint64_t first_level_bitmap_;
+    uint32_t second_level_bitmaps_[kFirstLevelCount];
+
+    // Количество блоков во всех списках свободных и их суммарный размер
+    StatCounter free_count_;
+    StatCounter free_bytes_;
+
+    // Все участки пула, последний из них - текущий
+    Chunk chunks_[kMaxChunks];
+    size_t chunk_count_;
+
+    // Суммарный размер всех участков
+    StatCounter total_size_;
+
+    // Сколько первых участков не принадлежат пулу и не освобождаются им:
+    // внешний буфер (options.buffer) или участки загруженного снимка
+    size_t external_chunks_;
+
+    // Отображение файла снимка (load_snapshot), снимается при разрушении пула
+    void* snapshot_mapping_;
+    size_t snapshot_mapping_size_;
+
+    // Корень загруженного снимка (см. save_snapshot)
+    void* snapshot_root_;
+
+    // Параметры роста (upstream_ == nullptr - пул фиксированный)
+    std::pmr::memory_resource* upstream_;
+    size_t growth_factor_;
+    size_t max_total_size_;
+
+    // Количество активных меток
+    size_t marker_depth_;
+
+    // Узел списка отложенных освобождений, лежит в области данных блока
+    struct DeferredNode {
+        DeferredNode* next;
+        size_t fragmentation;   // внутренняя фрагментация блока, уже вычтенная из статистики
+    };
+
+    // Отложенные освобождения: блоки, выделенные до активной метки и освобождённые после неё
+    // Возвращаются в пул при откате (сразу вернуть их нельзя - откат восстанавливает
+    // списки свободных на момент метки)
+    DeferredNode* deferred_;
+    size_t deferred_count_;
+    size_t deferred_fragmentation_;
+
+    // Запись трассы выделений (nullptr - не ведётся)
+    TraceRecorder* trace_;
+
+public:
+    // Полный размер блока в пуле под запрос bytes с обычным выравниванием
+    // (например, чтобы рассчитать размер пула под n узлов очереди)
+    static constexpr size_t block_size_for(size_t bytes) {
+        return std::max((kHeaderSize + bytes + kGuardSize + kBlockAlignment - 1) & ~(kBlockAlignment - 1),
+                        kMinBlockSize);
+    }
+
+    // Метка состояния пула: смещение вершины и списки свободных блоков
+    // Получается через mark(), используется в rollback()
+    class Marker {
+    private:
+        friend class FixedMemoryResource;
+
+        size_t depth_;
+        void* memory_pool_;
+        size_t pool_size_;
+        size_t current_offset_;
+        size_t top_prev_size_;
+        size_t chunk_count_;
+        size_t total_size_;
+        size_t allocated_count_;
+        size_t internal_fragmentation_;
+        size_t bytes_in_use_;
+        FreeNode* free_lists_[kFirstLevelCount][kSecondLevelCount];
+        uint64_t first_level_bitmap_;
+        uint32_t second_level_bitmaps_[kFirstLevelCount];
+        size_t free_count_;
+        size_t free_bytes_;
+        DeferredNode* deferred_;
+        size_t deferred_count_;
+        size_t deferred_fragmentation_;
+
+    public:
+        // Смещение вершины текущего участка на момент метки
+        size_t get_offset() const { return current_offset_; }
+    };
+
+    // Конструктор: выделяет фиксированный блок памяти заданного размера
+    // size - размер блока в байтах (по умолчанию 1 МБ)
+    // strategy - стратегия поиска свободных блоков
+    explicit FixedMemoryResource(size_t size = 1024 * 1024,
+                                 AllocationStrategy strategy = AllocationStrategy::SegregatedFit);
+
+    // Конструктор с полным набором параметров (в том числе растущий пул)
+    explicit FixedMemoryResource(const FixedMemoryResourceOptions& options);
+
+    // Деструктор: освобождает весь блок памяти
+    ~FixedMemoryResource() override;
+
+    // Запрещаем копирование (уникальныйй ресурс
+    FixedMemoryResource(const FixedMemoryResource&) = delete; //коп
+    FixedMemoryResource& operator=(const FixedMemoryResource&) = delete; //при коп
+
+    // Разрешаем перемещение (передача владения)
+    FixedMemoryResource(FixedMemoryResource&& other) noexcept; //пер
+    FixedMemoryResource& operator=(FixedMemoryResource&& other) noexcept; //присв пер
+
+    // Вывод статистики использования памяти
+    void print_stats() const;
+
+    // Снимок статистики: только чтение счётчиков, без обхода списков
+    // Можно вызывать из любого потока параллельно с работой владельца ресурса
+    // (поля снимка при этом могут быть взяты в немного разные моменты)
+    FixedMemoryStats stats() const;
+
+    // Подключение записи трассы (nullptr - отключить): каждый allocate, deallocate
+    // и release попадает в recorder, откаты к меткам - нет
+    // recorder должен жить, пока подключён
+    void set_trace_recorder(TraceRecorder* recorder) { trace_ = recorder; }
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+    // Гистограммы задержек: выводить можно из другого потока во время работы
+    void print_latency() const;
+
+    // Сброс - только из потока-владельца ресурса (как allocate/deallocate):
+    // запись измерения не атомарна, параллельный сброс рассогласовал бы счётчики и корзины
+    void reset_latency();
+    const LatencyHistogram& get_allocate_latency() const { return allocate_latency_; }
+    const LatencyHistogram& get_deallocate_latency() const { return deallocate_latency_; }
+#endif
+
+    // Пакетное выделение count блоков по bytes байт: указатели записываются в out[0..count)
+    // Если пакет помещается в неразмеченный остаток пула (растущий пул при нехватке
+    // подключает участок под весь пакет), блоки идут подряд с вершины, а счётчики
+    // обновляются один раз на пакет; иначе (в том числе при alignment больше 16)
+    // блоки выделяются по одному, с переиспользованием свободных
+    // Освобождаются блоки как обычно, по одному через deallocate
+    // Всё или ничего: при std::bad_alloc ни один блок пакета не остаётся выделенным
+    void allocate_bulk(void** out, size_t count, size_t bytes,
+                       size_t alignment = alignof(std::max_align_t));
+
+    // Увеличение занятого блока на месте: данные ptr (выделенного под old_bytes) остаются
+    // по тому же адресу, блок вмещает new_bytes
+    // Получается, если хватает хвоста самого блока, блок лежит у вершины текущего участка
+    // (сдвигается current_offset_) или за ним лежит свободный блок, которого хватает
+    // (он поглощается, лишнее возвращается в пул)
+    // Блоки, выделенные до активной метки, не растут: откат к метке их бы обрезал
+    // false - расти некуда, блок и пул не изменились (остаётся выделить новый блок и скопировать)
+    // С проверками выбрасывает std::invalid_argument, если ptr не занятый блок этого ресурса
+    bool try_expand(void* ptr, size_t old_bytes, size_t new_bytes);
+
+    // Уменьшение занятого блока на месте до new_bytes: освободившийся хвост возвращается
+    // в пул (к вершине или в списки свободных со слиянием соседа), если из него выйдет блок
+    // Дальше блок освобождается с размером new_bytes
+    // Выбрасывает std::invalid_argument, если new_bytes больше old_bytes
+    // (и с проверками - если ptr не занятый блок этого ресурса)
+    void shrink(void* ptr, size_t old_bytes, size_t new_bytes);
+
+    // Метка для фазы работы: всё, что выделено после неё, освобождается откатом за O(1)
+    // Пока метка активна, блоки, выделенные до неё, не переиспользуются,
+    // а их освобождение откладывается до отката
+    // Метки вкладываются друг в друга и откатываются в обратном порядке
+    Marker mark();
+
+    // Откат к метке: вершина и списки свободных восстанавливаются,
+    // все блоки, выделенные после метки, освобождаются без обхода
+    // Возвращает, сколько таких блоков ещё было занято (например, узлы очереди после discard);
+    // сам откат это число не проверяет - проверяет вызывающий или перегрузка ниже
+    // С проверками освобождаемая область заполняется мусором, чтобы обращения к ней были заметны
+    // Выбрасывает std::invalid_argument, если метка не самая внутренняя из активных
+    size_t rollback(const Marker& marker);
+
+    // Откат, после которого занятыми должны были остаться ровно expected_live блоков фазы
+    // (0 - фаза всё освободила сама, иначе - например, размер очереди перед discard)
+    // С проверками выбрасывает std::logic_error, если занятых блоков другое число;
+    // откат при этом уже выполнен
+    size_t rollback(const Marker& marker, size_t expected_live);
+
+    // Количество активных меток
+    size_t get_marker_depth() const { return marker_depth_; }
+
+    // Освобождение всех блоков разом (арена): пул возвращается в исходное состояние
+    // Списки свободных и статистика сбрасываются за O(1), дополнительные участки
+    // растущего пула возвращаются upstream, остаётся только первый
+    // Все ранее выделенные указатели становятся недействительными,
+    // освобождать их через deallocate больше нельзя
+    void release();
+
+    // Возврат системе страниц, целиком лежащих в свободной памяти пула:
+    // в неразмеченном остатке текущего участка и в больших свободных блоках
+    // (заголовок и узел списка свободного блока остаются на месте)
+    // Возвращает, сколько байт из них было резидентно, то есть на сколько уменьшился RSS
+    // Пул продолжает работать: при следующем обращении страницы выделятся заново
+    size_t trim(TrimAdvice advice = TrimAdvice::DontNeed);
+
+    // Резидентная (находящаяся в физической памяти) часть всех участков пула
+    size_t get_resident_bytes() const;
+
+    // Снимок пула в файл для быстрого перезапуска: заголовок с версией, раскладкой блоков
+    // и контрольными суммами, таблица участков и размеченные части участков как есть
+    // root - блок пула, с которого загрузивший начнёт разбор (например, состояние очереди,
+    // см. Queue::save_snapshot), nullptr - без корня
+    // Выбрасывает std::runtime_error при ошибке записи или активных метках,
+    // std::invalid_argument, если root не из этого пула
+    void save_snapshot(const std::string& path, const void* root = nullptr) const;
+
+    // Загрузка снимка: файл отображается в память (копирование при записи, файл не меняется),
+    // участки пула работают прямо в отображении, списки свободных строятся заново
+    // одним проходом по заголовкам блоков
+    // Указатели внутри данных остаются адресами сохранившего процесса - их пересчитывает relocate
+    // upstream - откуда брать новые участки, если пул растущий (nullptr - пул больше не растёт)
+    // Выбрасывает std::runtime_error, если файл не открылся, повреждён или сохранён
+    // сборкой с другой раскладкой блоков (например, усиленной)
+    static FixedMemoryResource load_snapshot(const std::string& path,
+                                             std::pmr::memory_resource* upstream = nullptr);
+
+    // Корень загруженного снимка; отдаётся один раз, чтобы его не разобрали дважды
+    // (nullptr - пул не из снимка, снимок без корня или корень уже забран)
+    void* take_snapshot_root() { return std::exchange(snapshot_root_, nullptr); }
+
+    // Пересчёт адреса из сохранившего снимок процесса в адрес этого пула (nullptr остаётся nullptr)
+    // Выбрасывает std::invalid_argument, если адрес не лежал в пуле
+    void* relocate(const void* saved) const;
+
+    // Методы для тестирования
+    size_t get_allocated_count() const { return allocated_count_; }
+    size_t get_free_count() const { return free_count_; }
+    size_t get_current_offset() const { return current_offset_; }
+    AllocationStrategy get_strategy() const { return strategy_; }
+    size_t get_chunk_count() const { return chunk_count_; }
+    size_t get_total_size() const { return total_size_; }
+    // Лежит ли указатель внутри пула (состояние блока не проверяется)
+    bool owns(const void* ptr) const;
+
+    // Метрики фрагментации (участки, которые ещё можно подключить, не учитываются)
+    // Вся свободная память (списки свободных + неразмеченный остаток пула)
+    size_t get_free_bytes() const;
+    // Наибольший непрерывный свободный участок
+    size_t get_largest_free_block() const;
+    // Внешняя фрагментация от 0 (свободная память непрерывна) до 1
+    double get_fragmentation() const;
+    // Внутренняя фрагментация в байтах
+    size_t get_internal_fragmentation() const { return internal_fragmentation_; }
+
+protected:
+    // Выделение памяти (переопределение виртуального метода базового класса)
+    // bytes - количество байт для выделения
+    // alignment - требуемое выравнивание адреса
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    // Освобождение памяти (переопределение виртуального метода базового класса)
+    // ptr - указатель на освобождаемый блок
+    // bytes - размер блока
+    // alignment - выравнивание блока
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+    // Сравнение memory_resource (переопределение виртуального метода)
+    // Два ресурса равны, если это один и тот же объект
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Поиск подходящего свободного блока для переиспользования
+    // size - полный размер блока вместе с заголовком
+    // Возвращает заголовок блока (уже вынутого из списка) или nullptr, если подходящий не найден
+    BlockHeader* find_free_block(size_t size, size_t alignment);
+
+    // Размещение выровненного блока внутри найденного свободного блока
+    // Возвращает указатель на данные пользователя
+    void* place_block(BlockHeader* header, size_t size, size_t alignment);
+
+    // Отступ от начала блока до блока с данными, выровненными на alignment
+    static size_t aligned_lead(const void* block_start, size_t alignment);
+
+    // Добавление блока в список свободных своего класса и удаление из него
+    void push_free_block(BlockHeader* header);
+    void remove_free_block(BlockHeader* header);
+
+    // Возврат блока в пул со слиянием соседних свободных блоков
+    void release_block(BlockHeader* header);
+
+    // Отрезание хвоста свободного блока до размера size (хвост возвращается в пул)
+    void split_block(BlockHeader* header, size_t size);
+
+    // Запись prev_size блоку, который начинается с адреса end
+    void set_next_prev_size(char* end, size_t size);
+
+    // Вершина текущего участка: адрес, с которого продолжается выделение
+    char* top() const;
+
+    // Подключение нового участка, в котором поместится блок min_size
+    // Остаток текущего участка становится свободным блоком, на его границе ставится заграждение
+    // Выбрасывает std::bad_alloc, если пул фиксированный или достигнут предел
+    void add_chunk(size_t min_size);
+
+    // Номер участка, в котором лежит ptr, или chunk_count_, если ptr чужой
+    size_t chunk_index_of(const void* ptr) const;
+
+    // Сброс всех списков свободных блоков
+    void clear_free_lists();
+
+    // Список, в котором хранятся свободные блоки полного размера size
+    ListIndex list_index_of(size_t size) const;
+
+    // Первый непустой список, начиная с index (по возрастанию размеров)
+    FreeNode* find_non_empty_list(ListIndex index) const;
+
+    // Проверка, что ptr - данные занятого блока этого ресурса и bytes в него помещается
+    // При нарушении выбрасывает std::invalid_argument
+    void validate_block(const void* ptr, size_t bytes) const;
+
+    // Учёт смены запрошенного размера блока: фрагментация, занятая память и трасса
+    // (в трассе - освобождение и новое выделение по тому же адресу)
+    void record_resize(void* ptr, size_t old_size, size_t old_bytes, size_t new_bytes);
+
+    // Заголовок блока по указателю на данные пользователя
+    static BlockHeader* header_of(void* ptr);
+    static const BlockHeader* header_of(const void* ptr);
+
+    // Контрольные байты за данными блока: заполнение после выделения и проверка при освобождении
+    // Проверка выбрасывает std::runtime_error, если данные записаны за конец блока
+    void guard_block(void* ptr, size_t bytes);
+    void check_guard(void* ptr, size_t bytes);
+
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    // Проверка узора в данных свободного блока перед повторным выделением
+    // Выбрасывает std::runtime_error (блок остаётся в списке), если в них писали после освобождения
+    void check_freed(BlockHeader* header);
+#endif
+
+    // Полный размер блока (без флагов и глубины)
+    static size_t block_size(const BlockHeader* header);
+
+    // Глубина метки, при которой создан блок
+    static size_t depth_of(const BlockHeader* header);
+
+    // Биты глубины для заголовков блоков, создаваемых сейчас
+    size_t depth_bits() const;
+
+    // Откладывание освобождения блока, выделенного до активной метки
+    void defer_release(BlockHeader* header, size_t fragmentation);
+
+    // Очистка всех ресурсов (вызывается в деструкторе)
+    void cleanup();
+
+    // Возврат участка туда, откуда он был взят (внешние участки не трогаются)
+    void free_chunk(size_t index);
+
+    // Восстановление списков свободных и счётчиков проходом по блокам загруженного снимка
+    void rebuild_from_blocks();
+};
+
+// Выровненная память пула InlineFixedMemoryResource
+template<size_t Size>
+struct InlineFixedMemoryResourceStorage {
+    static_assert(Size % 16 == 0, "Inline pool size must be a multiple of 16");
+    alignas(16) std::array<unsigned char, Size> storage_;
+};
+
+// FixedMemoryResource с пулом внутри самого объекта: ни одного обращения к куче,
+// можно создавать на стеке или статически
+// Пул фиксированный, поведение (списки свободных, метки, статистика) то же, что у FixedMemoryResource
+// Перемещение запрещено: пул не может сменить адрес
+// Память - базовый класс, чтобы она была создана раньше FixedMemoryResource
+template<size_t Size>
+class InlineFixedMemoryResource : private InlineFixedMemoryResourceStorage<Size>,
+                                  public FixedMemoryResource {
+public:
+    explicit InlineFixedMemoryResource(AllocationStrategy strategy = AllocationStrategy::SegregatedFit)
+        : FixedMemoryResource(make_options(strategy, this->storage_.data())) {}
+
+    InlineFixedMemoryResource(const InlineFixedMemoryResource&) = delete;
+    InlineFixedMemoryResource& operator=(const InlineFixedMemoryResource&) = delete;
+    InlineFixedMemoryResource(InlineFixedMemoryResource&&) = delete;
+    InlineFixedMemoryResource& operator=(InlineFixedMemoryResource&&) = delete;
+
+private:
+    static FixedMemoryResourceOptions make_options(AllocationStrategy strategy, void* buffer) {
+        FixedMemoryResourceOptions options;
+        options.initial_size = Size;
+        options.strategy = strategy;
+        options.buffer = buffer;
+        return options;
+    }
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "growable_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
+
+GrowableBuffer::GrowableBuffer(FixedMemoryResource& memory, size_t capacity)
+    : memory_(&memory), data_(nullptr), size_(0), capacity_(0), relocations_(0) {
+    reserve(capacity);
+}
+
+GrowableBuffer::~GrowableBuffer() {
+    reset();
+}
+
+GrowableBuffer::GrowableBuffer(GrowableBuffer&& other) noexcept
+    : memory_(other.memory_), data_(other.data_), size_(other.size_), capacity_(other.capacity_),
+      relocations_(other.relocations_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+}
+
+GrowableBuffer& GrowableBuffer::operator=(GrowableBuffer&& other) noexcept {
+    if (this != &other) {
+        reset();
+        memory_ = other.memory_;
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        relocations_ = other.relocations_;
+    }
+    return *this;
+}
+
+// Точная ёмкость: резервируют, когда итоговый размер известен заранее
+void GrowableBuffer::reserve(size_t capacity) {
+    if (capacity <= capacity_ || expand(capacity)) {
+        return;
+    }
+    relocate(capacity);
+}
+
+void GrowableBuffer::resize(size_t size) {
+    if (size > capacity_) {
+        grow(size);
+    }
+    if (size > size_) {
+        std::memset(data_ + size_, 0, size - size_);
+    }
+    size_ = size;
+}
+
+void GrowableBuffer::grow_by(size_t bytes) {
+    if (bytes > std::numeric_limits<size_t>::max() - size_) {
+        throw std::bad_alloc();
+    }
+    grow(size_ + bytes);
+}
+
+void GrowableBuffer::shrink_to_fit() {
+    if (!data_ || size_ == capacity_) {
+        return;
+    }
+    if (size_ == 0) {
+        reset();
+        return;
+    }
+    memory_->shrink(data_, capacity_, size_);
+    capacity_ = size_;
+}
+
+// Сначала на месте с запасом, затем на месте ровно под needed (лучше тесный блок,
+// чем копирование), и только потом перенос с запасом
+void GrowableBuffer::grow(size_t needed) {
+    size_t target = capacity_ > std::numeric_limits<size_t>::max() / 2
+        ? needed
+        : std::max(needed, capacity_ * 2);
+    if (expand(target) || (target != needed && expand(needed))) {
+        return;
+    }
+    relocate(target);
+}
+
+bool GrowableBuffer::expand(size_t capacity) {
+    if (!data_ || !memory_->try_expand(data_, capacity_, capacity)) {
+        return false;
+    }
+    capacity_ = capacity;
+    return true;
+}
+
+void GrowableBuffer::relocate(size_t capacity) {
+    auto* data = static_cast<char*>(memory_->allocate(capacity));
+    if (data_) {
+        std::memcpy(data, data_, size_);
+        memory_->deallocate(data_, capacity_);
+        ++relocations_;
+    }
+    data_ = data;
+    capacity_ = capacity;
+}
+
+void GrowableBuffer::reset() {
+    if (data_) {
+        memory_->deallocate(data_, capacity_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    capacity_ = 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef GROWABLE_BUFFER_H
+#define GROWABLE_BUFFER_H
+
+#include "fixed_memory_resource.h"
+#include <cstddef>
+#include <cstring>
+
+// Растущий байтовый буфер в пуле FixedMemoryResource (например, данные переменной длины
+// рядом с узлами очереди)
+// Рост сначала пробует FixedMemoryResource::try_expand: если блок у вершины пула или за ним
+// свободное место, данные не копируются; иначе - новый блок, копирование, освобождение старого
+// Ёмкость растёт геометрически, shrink_to_fit отдаёт лишнее через FixedMemoryResource::shrink
+// Буфер выравнен на alignof(std::max_align_t)
+class GrowableBuffer {
+private:
+    FixedMemoryResource* memory_;
+    char* data_;
+    size_t size_;
+    size_t capacity_;
+
+    // Сколько раз при росте пришлось переносить данные в новый блок
+    size_t relocations_;
+
+public:
+    // Пустой буфер; capacity - сразу зарезервировать столько байт
+    explicit GrowableBuffer(FixedMemoryResource& memory, size_t capacity = 0);
+
+    // Возвращает блок в пул
+    ~GrowableBuffer();
+
+    GrowableBuffer(const GrowableBuffer&) = delete;
+    GrowableBuffer& operator=(const GrowableBuffer&) = delete;
+
+    GrowableBuffer(GrowableBuffer&& other) noexcept;
+    GrowableBuffer& operator=(GrowableBuffer&& other) noexcept;
+
+    // Ёмкость не меньше capacity (на месте, если получится)
+    // Выбрасывает std::bad_alloc, если пул исчерпан (буфер не меняется)
+    void reserve(size_t capacity);
+
+    // Новый размер; добавленные байты заполняются нулями
+    void resize(size_t size);
+
+    // Дописывание bytes байт из data в конец
+    // Встраивается: пока хватает ёмкости, это одно копирование
+    void append(const void* data, size_t bytes) {
+        if (bytes > capacity_ - size_) {
+            grow_by(bytes);
+        }
+        if (bytes != 0) {
+            std::memcpy(data_ + size_, data, bytes);
+        }
+        size_ += bytes;
+    }
+
+    // Размер обнуляется, ёмкость остаётся
+    void clear() { size_ = 0; }
+
+    // Ёмкость уменьшается до размера, хвост блока возвращается в пул (без перемещения данных)
+    void shrink_to_fit();
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    FixedMemoryResource* resource() const { return memory_; }
+    size_t get_relocation_count() const { return relocations_; }
+
+private:
+    // Рост под needed байт: вдвое (но не меньше needed), на месте, если можно
+    void grow(size_t needed);
+
+    // Рост под ещё bytes байт сверх размера
+    void grow_by(size_t bytes);
+
+    // Увеличение ёмкости блока на месте; false - не вышло, буфер не изменился
+    bool expand(size_t capacity);
+
+    // Перенос данных в новый блок ёмкостью capacity
+    void relocate(size_t capacity);
+
+    // Возврат блока в пул
+    void reset();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "latency_histogram.h"
+#include "bit_utils.h"
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+LatencyHistogram::LatencyHistogram() : min_(std::numeric_limits<uint64_t>::max()) {}
+
+// Учёт измерения: корзина, сумма и границы
+void LatencyHistogram::record(uint64_t cycles) {
+    ++buckets_[bucket_of(cycles)];
+    ++count_;
+    sum_ += cycles;
+    if (cycles < min_) {
+        min_ = cycles;
+    }
+    max_.raise_to(cycles);
+}
+
+void LatencyHistogram::reset() {
+    for (StatCounter& bucket : buckets_) {
+        bucket = 0;
+    }
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+// Вывод сводки: перцентили берутся по верхним границам корзин
+void LatencyHistogram::print(std::ostream& out, const char* title) const {
+    out << title << " (тактов): измерений " << get_count();
+    if (get_count() != 0) {
+        out << ", среднее " << get_mean()
+            << ", мин " << get_min()
+            << ", p50 " << get_percentile(50.0)
+            << ", p90 " << get_percentile(90.0)
+            << ", p99 " << get_percentile(99.0)
+            << ", p99.9 " << get_percentile(99.9)
+            << ", макс " << get_max();
+    }
+    out << "\n";
+}
+
+double LatencyHistogram::get_mean() const {
+    size_t count = count_;
+    return count == 0 ? 0.0 : static_cast<double>(sum_.get()) / static_cast<double>(count);
+}
+
+// Перцентиль: первая корзина, на которой накопленное количество достигает доли percent
+uint64_t LatencyHistogram::get_percentile(double percent) const {
+    size_t count = count_;
+    if (count == 0) {
+        return 0;
+    }
+    double target = std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(count);
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += buckets_[bucket];
+        if (seen != 0 && static_cast<double>(seen) >= target) {
+            // Верхняя граница корзины не больше фактического максимума
+            return std::min(bucket_upper(bucket), get_max());
+        }
+    }
+    return get_max();
+}
+
+// Октава k >= 1 - значения [2^(k+3), 2^(k+4)), внутри неё корзина по следующим 4 битам
+size_t LatencyHistogram::bucket_of(uint64_t value) {
+    if (value < kSubBucketCount) {
+        return static_cast<size_t>(value);
+    }
+    size_t shift = floor_log2(value) - kSubBucketLog2;
+    return (shift + 1) * kSubBucketCount + static_cast<size_t>((value >> shift) & (kSubBucketCount - 1));
+}
+
+uint64_t LatencyHistogram::bucket_lower(size_t bucket) {
+    if (bucket < kSubBucketCount) {
+        return bucket;
+    }
+    size_t shift = bucket / kSubBucketCount - 1;
+    return (kSubBucketCount + bucket % kSubBucketCount) << shift;
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < kSubBucketCount) {
+        return bucket;
+    }
+    size_t shift = bucket / kSubBucketCount - 1;
+    return bucket_lower(bucket) + ((uint64_t{1} << shift) - 1);
+}
\ No newline at end of file
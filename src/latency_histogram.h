@@ -0,0 +1,101 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "stat_counter.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define LATENCY_HISTOGRAM_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LATENCY_HISTOGRAM_RDTSC 1
+#elif !defined(__aarch64__)
+#include <chrono>
+#endif
+
+// Текущее значение счётчика тактов процессора
+// x86 - rdtsc (на современных процессорах идёт с постоянной частотой),
+// arm64 - виртуальный таймер cntvct_el0, иначе - наносекунды steady_clock
+inline uint64_t read_cycle_counter() {
+#if defined(LATENCY_HISTOGRAM_RDTSC)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Гистограмма задержек в тактах с лог-линейными корзинами (как в HdrHistogram):
+// значения до kSubBucketCount хранятся точно, каждая следующая октава [2^k, 2^(k+1))
+// делится на kSubBucketCount равных корзин, поэтому относительная погрешность
+// не больше 1 / kSubBucketCount при постоянном размере таблицы
+// Пишет и сбрасывает один поток, читать и выводить можно из любого (счётчики - StatCounter)
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBucketLog2 = 4;
+    static constexpr size_t kSubBucketCount = size_t{1} << kSubBucketLog2;
+    // Октава 0 - точные значения [0, kSubBucketCount), затем октавы до 2^64
+    static constexpr size_t kBucketCount = (64 - kSubBucketLog2 + 1) * kSubBucketCount;
+
+private:
+    StatCounter buckets_[kBucketCount];
+    StatCounter count_;
+    StatCounter sum_;
+    StatCounter min_;
+    StatCounter max_;
+
+public:
+    LatencyHistogram();
+
+    // Учёт одного измерения
+    void record(uint64_t cycles);
+
+    // Обнуление всех корзин - только из пишущего потока
+    // (record не атомарен: параллельный сброс затёрся бы старыми значениями счётчиков)
+    void reset();
+
+    // Вывод количества, среднего и перцентилей
+    void print(std::ostream& out, const char* title) const;
+
+    size_t get_count() const { return count_; }
+    uint64_t get_min() const { return count_ == 0 ? 0 : min_.get(); }
+    uint64_t get_max() const { return max_; }
+    double get_mean() const;
+
+    // Значение, не меньше которого percent процентов измерений
+    // (верхняя граница корзины, в которую попал перцентиль)
+    uint64_t get_percentile(double percent) const;
+
+    size_t get_bucket_count(size_t bucket) const { return buckets_[bucket]; }
+
+    // Корзина значения и её границы
+    static size_t bucket_of(uint64_t value);
+    static uint64_t bucket_lower(size_t bucket);
+    static uint64_t bucket_upper(size_t bucket);
+};
+
+// Замер задержки области видимости: время от создания до разрушения
+// попадает в гистограмму (в том числе при выходе по исключению)
+class LatencyTimer {
+private:
+    LatencyHistogram& histogram_;
+    uint64_t start_;
+
+public:
+    explicit LatencyTimer(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(read_cycle_counter()) {}
+
+    ~LatencyTimer() { histogram_.record(read_cycle_counter() - start_); }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+};
+
+#endif
\ No newline at end of file
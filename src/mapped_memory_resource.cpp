@@ -0,0 +1,137 @@
+#include "mapped_memory_resource.h"
+#include "bit_utils.h"
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MAPPED_MEMORY_RESOURCE_MMAP 1
+#else
+#define MAPPED_MEMORY_RESOURCE_MMAP 0
+#endif
+
+namespace {
+
+// Размер большой страницы (2 МБ на x86-64 и большинстве конфигураций arm64)
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+#if MAPPED_MEMORY_RESOURCE_MMAP
+// Анонимное отображение size байт, выровненное на alignment (степень двойки, кратная странице)
+// Отображаем с запасом и обрезаем невыровненные края
+void* map_aligned(size_t size, size_t alignment, int extra_flags) {
+    size_t padded = alignment > static_cast<size_t>(sysconf(_SC_PAGESIZE)) ? size + alignment : size;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags,
+                     -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+
+    char* start = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>(align_up(reinterpret_cast<uintptr_t>(start), alignment));
+    if (aligned != start) {
+        munmap(start, static_cast<size_t>(aligned - start));
+    }
+    size_t tail = padded - static_cast<size_t>(aligned - start) - size;
+    if (tail != 0) {
+        munmap(aligned + size, tail);
+    }
+    return aligned;
+}
+#endif
+
+}
+
+// Конструктор: определяет размер страницы для округления отображений
+MappedMemoryResource::MappedMemoryResource(const MappedMemoryOptions& options)
+    : options_(options), page_size_(4096), mapping_count_(0), mapped_bytes_(0),
+      huge_page_fallbacks_(0), lock_failures_(0) {
+#if MAPPED_MEMORY_RESOURCE_MMAP
+    page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    // Большие страницы покрывают только выровненные на 2 МБ участки целиком
+    if (options_.huge_pages != HugePages::None) {
+        page_size_ = kHugePageSize;
+    }
+}
+
+// Выделение: отдельное отображение на каждый запрос
+void* MappedMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment > page_size_) {
+        throw std::bad_alloc();
+    }
+    size_t size = mapping_size(bytes);
+
+#if MAPPED_MEMORY_RESOURCE_MMAP
+    size_t system_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    int populate = 0;
+#ifdef MAP_POPULATE
+    if (options_.populate) {
+        populate = MAP_POPULATE;
+    }
+#endif
+
+    void* ptr = nullptr;
+#ifdef MAP_HUGETLB
+    if (options_.huge_pages == HugePages::Explicit) {
+        // Страницы из пула hugetlbfs уже выровнены на свой размер
+        ptr = map_aligned(size, system_page_size, MAP_HUGETLB | populate);
+        if (!ptr) {
+            ++huge_page_fallbacks_;
+        }
+    }
+#endif
+    if (!ptr) {
+        // Для прозрачных больших страниц подсказку нужно дать до первого обращения,
+        // поэтому заполнять страницы через MAP_POPULATE можно только без неё
+        int flags = options_.huge_pages == HugePages::None ? populate : 0;
+        ptr = map_aligned(size, page_size_, flags);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (options_.huge_pages != HugePages::None) {
+            madvise(ptr, size, MADV_HUGEPAGE);
+        }
+#endif
+        if (options_.populate && flags == 0) {
+            // Первое касание каждой страницы: page fault случается здесь, а не на горячем пути
+            char* page = static_cast<char*>(ptr);
+            for (size_t offset = 0; offset < size; offset += system_page_size) {
+                page[offset] = 0;
+            }
+        }
+    }
+
+    if (options_.lock && mlock(ptr, size) != 0) {
+        ++lock_failures_;
+    }
+#else
+    void* ptr = ::operator new(size, std::align_val_t{page_size_});
+#endif
+
+    ++mapping_count_;
+    mapped_bytes_ += size;
+    return ptr;
+}
+
+// Освобождение: размер отображения однозначно восстанавливается по bytes
+void MappedMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t /*alignment*/) {
+    size_t size = mapping_size(bytes);
+#if MAPPED_MEMORY_RESOURCE_MMAP
+    // munmap снимает и закрепление mlock
+    munmap(ptr, size);
+#else
+    ::operator delete(ptr, std::align_val_t{page_size_});
+#endif
+    --mapping_count_;
+    mapped_bytes_ -= size;
+}
+
+// Сравнение memory_resource
+bool MappedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+size_t MappedMemoryResource::mapping_size(size_t bytes) const {
+    return align_up(bytes == 0 ? 1 : bytes, page_size_);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef MAPPED_MEMORY_RESOURCE_H
+#define MAPPED_MEMORY_RESOURCE_H
+
+#include <memory_resource>
+#include <cstddef>
+
+// Использование больших страниц
+enum class HugePages {
+    // Обычные страницы
+    None,
+
+    // Прозрачные большие страницы: отображение помечается madvise(MADV_HUGEPAGE),
+    // ядро подставляет большие страницы, когда может
+    Transparent,
+
+    // Явные большие страницы из зарезервированного пула (MAP_HUGETLB)
+    // Если зарезервированных страниц нет, отображение делается как для Transparent
+    Explicit
+};
+
+// Параметры MappedMemoryResource
+struct MappedMemoryOptions {
+    HugePages huge_pages = HugePages::None;
+
+    // Заранее отобразить все страницы (MAP_POPULATE), чтобы первое обращение
+    // к памяти не вызывало page fault
+    bool populate = false;
+
+    // Закрепить страницы в памяти (mlock), чтобы они не вытеснялись в swap
+    bool lock = false;
+};
+
+// Источник больших участков памяти напрямую из mmap
+// Каждый запрос обслуживается отдельным отображением, размер округляется до страницы
+// Предназначен на роль upstream для FixedMemoryResource:
+//   MappedMemoryResource mapped({HugePages::Transparent, true, true});
+//   FixedMemoryResourceOptions options;
+//   options.initial_size = size;
+//   options.upstream = &mapped;
+//   options.max_total_size = size; // без роста - пул остаётся фиксированным
+//   FixedMemoryResource memory(options);
+// Без mmap (не POSIX) память берётся из operator new с выравниванием на страницу,
+// параметры при этом не действуют
+class MappedMemoryResource : public std::pmr::memory_resource {
+private:
+    MappedMemoryOptions options_;
+
+    // Размер страницы, до которого округляются отображения
+    size_t page_size_;
+
+    // Статистика
+    size_t mapping_count_;
+    size_t mapped_bytes_;
+    size_t huge_page_fallbacks_;
+    size_t lock_failures_;
+
+public:
+    // Конструктор: запоминает параметры, память отображается при запросах
+    explicit MappedMemoryResource(const MappedMemoryOptions& options = MappedMemoryOptions{});
+
+    // Ресурс уникален: копирование и перемещение запрещены
+    MappedMemoryResource(const MappedMemoryResource&) = delete;
+    MappedMemoryResource& operator=(const MappedMemoryResource&) = delete;
+
+    // Методы для тестирования
+    const MappedMemoryOptions& get_options() const { return options_; }
+    size_t get_page_size() const { return page_size_; }
+    size_t get_mapping_count() const { return mapping_count_; }
+    size_t get_mapped_bytes() const { return mapped_bytes_; }
+    // Сколько раз не нашлось зарезервированных больших страниц (HugePages::Explicit)
+    size_t get_huge_page_fallbacks() const { return huge_page_fallbacks_; }
+    // Сколько раз mlock не удался (например, из-за RLIMIT_MEMLOCK)
+    // Память при этом выдаётся, но может вытесняться
+    size_t get_lock_failures() const { return lock_failures_; }
+
+protected:
+    // Выделение: новое отображение; выравнивание больше страницы не поддерживается
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    // Освобождение: отображение снимается целиком
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Размер отображения для запроса bytes
+    size_t mapping_size(size_t bytes) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "metrics_exporter.h"
+#include "concurrent_fixed_memory_resource.h"
+#include <charconv>
+#include <cstdio>
+
+namespace {
+
+// Числовая метрика пула: имя, тип и описание для Prometheus и поле снимка
+struct PoolMetric {
+    const char* name;
+    const char* type;
+    const char* help;
+    size_t FixedMemoryStats::*field;
+};
+
+const PoolMetric kPoolMetrics[] = {
+    {"bytes_in_use", "gauge", "Pool bytes held by allocated blocks, headers included",
+     &FixedMemoryStats::bytes_in_use},
+    {"peak_bytes_in_use", "gauge", "High-water mark of bytes_in_use",
+     &FixedMemoryStats::peak_bytes_in_use},
+    {"allocations_total", "counter", "allocate calls", &FixedMemoryStats::allocations},
+    {"deallocations_total", "counter", "deallocate calls", &FixedMemoryStats::deallocations},
+    {"free_list_hits_total", "counter", "Allocations served from the free lists",
+     &FixedMemoryStats::free_list_hits},
+    {"bump_allocations_total", "counter", "Allocations served by moving the pool top",
+     &FixedMemoryStats::bump_allocations},
+    {"failed_allocations_total", "counter", "Allocations that threw std::bad_alloc",
+     &FixedMemoryStats::failed_allocations},
+    {"internal_fragmentation_bytes", "gauge", "Bytes in allocated blocks beyond the requested size",
+     &FixedMemoryStats::internal_fragmentation},
+};
+
+// Числа дописываются без промежуточных строк
+void append_number(std::string& out, size_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void append_number(std::string& out, double value) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.6g", value);
+    out.append(digits, static_cast<size_t>(length));
+}
+
+// Экранирование значения метки Prometheus: только обратная косая, кавычка и перевод строки
+void append_prometheus_label(std::string& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+}
+
+// Экранирование строки JSON: кроме обратной косой и кавычки - все управляющие символы
+// U+0000-U+001F (короткой формой, где она есть, иначе \u00XX)
+void append_json_string(std::string& out, const std::string& text) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    for (char c : text) {
+        auto code = static_cast<unsigned char>(c);
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\r') {
+            out += "\\r";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (code < 0x20) {
+            out += "\\u00";
+            out += kHex[code >> 4];
+            out += kHex[code & 0xF];
+        } else {
+            out += c;
+        }
+    }
+}
+
+// Верхняя граница корзины гистограммы размеров (см. FixedMemoryStats::kHistogramBuckets)
+size_t histogram_bound(size_t bucket) {
+    return size_t{16} << bucket;
+}
+
+// Заголовок семейства метрик Prometheus
+void append_family(std::string& out, const char* prefix, const char* name, const char* type,
+                   const char* help) {
+    out += "# HELP lab05_";
+    out += prefix;
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE lab05_";
+    out += prefix;
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// Начало строки метрики: имя и метка источника
+void append_sample(std::string& out, const char* prefix, const char* name, const char* label,
+                   const std::string& source) {
+    out += "lab05_";
+    out += prefix;
+    out += name;
+    out += '{';
+    out += label;
+    out += "=\"";
+    append_prometheus_label(out, source);
+    out += '"';
+}
+
+}
+
+MetricsExporter::MetricsExporter() : stop_(false) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::add_pool(const std::string& name, const FixedMemoryResource& pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pools_.push_back({name, [&pool] { return pool.stats(); }});
+    snapshots_.reserve(pools_.size());
+}
+
+void MetricsExporter::add_pool(const std::string& name, const ConcurrentFixedMemoryResource& pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pools_.push_back({name, [&pool] { return pool.stats(); }});
+    snapshots_.reserve(pools_.size());
+}
+
+void MetricsExporter::add_queue(const std::string& name, const QueueMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queues_.push_back({name, &metrics});
+}
+
+std::string MetricsExporter::render(MetricsFormat format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    render_locked(format);
+    return buffer_;
+}
+
+bool MetricsExporter::write_file(const std::string& path, MetricsFormat format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_file_locked(path, path + ".tmp", format);
+}
+
+// Поток спит на условной переменной, поэтому stop не ждёт окончания интервала
+void MetricsExporter::start(const std::string& path, std::chrono::milliseconds interval,
+                            MetricsFormat format) {
+    stop();
+    stop_ = false;
+    thread_ = std::thread([this, path, interval, format] {
+        std::string temp_path = path + ".tmp";
+        std::unique_lock<std::mutex> lock(mutex_);
+        do {
+            write_file_locked(path, temp_path, format);
+        } while (!wakeup_.wait_for(lock, interval, [this] { return stop_; }));
+    });
+}
+
+void MetricsExporter::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+}
+
+// Снимки всех пулов берутся один раз, затем выводятся по семействам метрик
+void MetricsExporter::render_locked(MetricsFormat format) {
+    snapshots_.clear();
+    for (const PoolSource& pool : pools_) {
+        snapshots_.push_back(pool.stats());
+    }
+
+    buffer_.clear();
+    if (format == MetricsFormat::Prometheus) {
+        render_prometheus();
+    } else {
+        render_json();
+    }
+}
+
+void MetricsExporter::render_prometheus() {
+    std::string& out = buffer_;
+
+    if (!pools_.empty()) {
+        for (const PoolMetric& metric : kPoolMetrics) {
+            append_family(out, "pool_", metric.name, metric.type, metric.help);
+            for (size_t i = 0; i < pools_.size(); ++i) {
+                append_sample(out, "pool_", metric.name, "pool", pools_[i].name);
+                out += "} ";
+                append_number(out, snapshots_[i].*metric.field);
+                out += '\n';
+            }
+        }
+
+        append_family(out, "pool_", "external_fragmentation_ratio", "gauge",
+                      "Share of free pool memory split into free-list blocks");
+        for (size_t i = 0; i < pools_.size(); ++i) {
+            append_sample(out, "pool_", "external_fragmentation_ratio", "pool", pools_[i].name);
+            out += "} ";
+            append_number(out, snapshots_[i].external_fragmentation);
+            out += '\n';
+        }
+
+        // Корзины не накопительные, поэтому это счётчики с меткой max_bytes, а не histogram
+        append_family(out, "pool_", "allocations_by_size_total", "counter",
+                      "Allocations by requested size, up to max_bytes");
+        for (size_t i = 0; i < pools_.size(); ++i) {
+            for (size_t bucket = 0; bucket < FixedMemoryStats::kHistogramBuckets; ++bucket) {
+                append_sample(out, "pool_", "allocations_by_size_total", "pool", pools_[i].name);
+                out += ",max_bytes=\"";
+                if (bucket + 1 == FixedMemoryStats::kHistogramBuckets) {
+                    out += "+Inf";
+                } else {
+                    append_number(out, histogram_bound(bucket));
+                }
+                out += "\"} ";
+                append_number(out, snapshots_[i].size_histogram[bucket]);
+                out += '\n';
+            }
+        }
+    }
+
+    if (!queues_.empty()) {
+        struct QueueMetric {
+            const char* name;
+            const char* type;
+            const char* help;
+            StatCounter QueueMetrics::*field;
+        };
+        static const QueueMetric kQueueMetrics[] = {
+            {"depth", "gauge", "Elements currently in the queue", &QueueMetrics::depth},
+            {"pushes_total", "counter", "Elements pushed", &QueueMetrics::pushes},
+            {"pops_total", "counter", "Elements popped", &QueueMetrics::pops},
+        };
+        for (const QueueMetric& metric : kQueueMetrics) {
+            append_family(out, "queue_", metric.name, metric.type, metric.help);
+            for (const QueueSource& queue : queues_) {
+                append_sample(out, "queue_", metric.name, "queue", queue.name);
+                out += "} ";
+                append_number(out, (queue.metrics->*metric.field).get());
+                out += '\n';
+            }
+        }
+    }
+}
+
+void MetricsExporter::render_json() {
+    std::string& out = buffer_;
+
+    out += "{\"pools\":{";
+    for (size_t i = 0; i < pools_.size(); ++i) {
+        const FixedMemoryStats& stats = snapshots_[i];
+        if (i != 0) {
+            out += ',';
+        }
+        out += '"';
+        append_json_string(out, pools_[i].name);
+        out += "\":{";
+        for (const PoolMetric& metric : kPoolMetrics) {
+            out += '"';
+            out += metric.name;
+            out += "\":";
+            append_number(out, stats.*metric.field);
+            out += ',';
+        }
+        out += "\"external_fragmentation_ratio\":";
+        append_number(out, stats.external_fragmentation);
+        out += ",\"size_histogram\":[";
+        for (size_t bucket = 0; bucket < FixedMemoryStats::kHistogramBuckets; ++bucket) {
+            if (bucket != 0) {
+                out += ',';
+            }
+            append_number(out, stats.size_histogram[bucket]);
+        }
+        out += "]}";
+    }
+
+    out += "},\"queues\":{";
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        const QueueMetrics& metrics = *queues_[i].metrics;
+        if (i != 0) {
+            out += ',';
+        }
+        out += '"';
+        append_json_string(out, queues_[i].name);
+        out += "\":{\"depth\":";
+        append_number(out, metrics.depth.get());
+        out += ",\"pushes_total\":";
+        append_number(out, metrics.pushes.get());
+        out += ",\"pops_total\":";
+        append_number(out, metrics.pops.get());
+        out += '}';
+    }
+    out += "}}\n";
+}
+
+bool MetricsExporter::write_file_locked(const std::string& path, const std::string& temp_path,
+                                        MetricsFormat format) {
+    render_locked(format);
+
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(buffer_.data(), 1, buffer_.size(), file) == buffer_.size();
+    written = std::fclose(file) == 0 && written;
+    return written && std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include "fixed_memory_resource.h"
+#include "queue.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ConcurrentFixedMemoryResource;
+
+// Формат выгрузки метрик
+enum class MetricsFormat {
+    // Текстовый формат Prometheus (text exposition format 0.0.4)
+    Prometheus,
+    Json
+};
+
+// Выгрузка статистики пулов (FixedMemoryStats) и счётчиков очередей (QueueMetrics)
+// для мониторинга вместо разбора вывода print_stats
+// Источники только читаются через счётчики StatCounter, поэтому выгрузка
+// не вмешивается в работу пулов и очередей и ничего не выделяет на их горячем пути
+// Текст собирается в переиспользуемый буфер, после первой выгрузки без новых выделений
+// Фоновый поток раз в интервал пишет выгрузку в файл: во временный, затем rename,
+// поэтому читатель (например, textfile collector node_exporter) не видит файл недописанным
+class MetricsExporter {
+private:
+    struct PoolSource {
+        std::string name;
+        std::function<FixedMemoryStats()> stats;
+    };
+
+    struct QueueSource {
+        std::string name;
+        const QueueMetrics* metrics;
+    };
+
+    // Источники и буфер защищены mutex_ (его берут только регистрация и выгрузка)
+    std::mutex mutex_;
+    std::vector<PoolSource> pools_;
+    std::vector<QueueSource> queues_;
+    std::vector<FixedMemoryStats> snapshots_;
+    std::string buffer_;
+
+    // Фоновая запись
+    std::thread thread_;
+    std::condition_variable wakeup_;
+    bool stop_;
+
+public:
+    MetricsExporter();
+
+    // Деструктор останавливает фоновую запись
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Регистрация источников; name попадает в метку pool/queue
+    // Источник должен жить, пока зарегистрирован (то есть до уничтожения экспортёра)
+    void add_pool(const std::string& name, const FixedMemoryResource& pool);
+    void add_pool(const std::string& name, const ConcurrentFixedMemoryResource& pool);
+    void add_queue(const std::string& name, const QueueMetrics& metrics);
+
+    // Текущие значения в заданном формате
+    std::string render(MetricsFormat format);
+
+    // Запись текущих значений в файл (через временный файл path.tmp и rename)
+    // Возвращает false при ошибке записи
+    bool write_file(const std::string& path, MetricsFormat format);
+
+    // Фоновая запись в файл раз в interval; повторный вызов меняет параметры
+    void start(const std::string& path, std::chrono::milliseconds interval,
+               MetricsFormat format = MetricsFormat::Prometheus);
+    void stop();
+
+private:
+    // Сборка выгрузки в buffer_ (mutex_ захвачен)
+    void render_locked(MetricsFormat format);
+    void render_prometheus();
+    void render_json();
+    bool write_file_locked(const std::string& path, const std::string& temp_path, MetricsFormat format);
+};
+
+#endif
\ No newline at end of file
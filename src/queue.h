@@ -1,297 +1,574 @@
-#ifndef QUEUE_H
-#define QUEUE_H
-
-#include <memory>
-#include <memory_resource>
-#include <iterator>
-#include <stdexcept>
-
-// Шаблонный контейнер очередь (FIFO - First In, First Out)
-// Реализован на основе односвязного списка
-// Использует polymorphic_allocator для управления памятью
-template<typename T>
-class Queue {
-private:
-    // Узел односвязного списка
-    struct Node {
-        T data;           // Данные пользователя
-        Node* next;       // Указатель на следующий узел
-        
-        template<typename... Args>
-        Node(Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
-    };
-    
-    // Указатель на первый элемент очереди (откуда удаляем)
-    Node* head_;
-    
-    // Указатель на последний элемент очереди (куда добавляем)
-    Node* tail_;
-    
-    // Количество элементов в очереди
-    size_t size_;
-    
-    // Аллокатор для выделения памяти под узлы
-    // Использует переданный memory_resource через polymorphic_allocator
-    std::pmr::polymorphic_allocator<Node> allocator_;
-
-public:
-    // Forward-итератор для обхода элементов очереди
-    // Позволяет двигаться только вперёд (односвязный список)
-    class Iterator {
-    private:
-        Node* current_;  // Текущий узел
-        
-    public:
-        // Обязательные typedef для итератора
-        using iterator_category = std::forward_iterator_tag;  // Категория итератора
-        using value_type = T;                                  // Тип элемента
-        using difference_type = std::ptrdiff_t;               // Тип разности
-        using pointer = T*;                                    // Тип указателя
-        using reference = T&;                                  // Тип ссылки
-        
-        // Конструктор итератора
-        explicit Iterator(Node* node = nullptr) : current_(node) {}
-        
-        // Оператор разыменования: получить ссылку на данные
-        reference operator*() const {
-            if (!current_) {
-                throw std::runtime_error("Dereferencing end iterator");
-            }
-            return current_->data;
-        }
-        
-        // Оператор стрелка: доступ к членам объекта
-        pointer operator->() const {
-            if (!current_) {
-                throw std::runtime_error("Dereferencing end iterator");
-            }
-            return &(current_->data);
-        }
-        
-        // Префиксный инкремент: ++it
-        // Перемещает итератор к следующему элементу
-        Iterator& operator++() {
-            if (current_) {
-                current_ = current_->next;
-            }
-            return *this;
-        }
-        
-        // Постфиксный инкремент: it++
-        // Возвращает копию старого состояния, затем инкрементирует
-        Iterator operator++(int) {
-            Iterator tmp = *this;
-            ++(*this);
-            return tmp;
-        }
-        
-        // Операторы сравнения
-        bool operator==(const Iterator& other) const {
-            return current_ == other.current_;
-        }
-        
-        bool operator!=(const Iterator& other) const {
-            return current_ != other.current_;
-        }
-    };
-    
-    // Конструктор: создаёт пустую очередь
-    // mr - указатель на memory_resource для выделения памяти
-    explicit Queue(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
-        : head_(nullptr), tail_(nullptr), size_(0), allocator_(mr) {}
-    
-    // Деструктор: освобождает всю память
-    ~Queue() {
-        clear();
-    }
-    
-    // Конструктор копирования: создаёт глубокую копию очереди
-    // Все узлы копируются, создаются новые объекты
-    Queue(const Queue& other)
-        : head_(nullptr), tail_(nullptr), size_(0), allocator_(other.allocator_) {
-        
-        // Копируем все элементы из other
-        for (Node* current = other.head_; current != nullptr; current = current->next) {
-            push(current->data);
-        }
-    }
-    
-    // Оператор присваивания копированием
-    Queue& operator=(const Queue& other) {
-        if (this != &other) {
-            // Очищаем текущую очередь
-            clear();
-            
-            // Копируем элементы из other
-            for (Node* current = other.head_; current != nullptr; current = current->next) {
-                push(current->data);
-            }
-        }
-        return *this;
-    }
-    
-    // Конструктор перемещения: забирает содержимое из other
-    // other остаётся в валидном, но пустом состоянии
-    Queue(Queue&& other) noexcept
-        : head_(other.head_),
-          tail_(other.tail_),
-          size_(other.size_),
-          allocator_(other.allocator_.resource()) {
-        
-        // Обнуляем other, чтобы он не удалил узлы при уничтожении
-        other.head_ = nullptr;
-        other.tail_ = nullptr;
-        other.size_ = 0;
-    }
-    
-    // Оператор присваивания перемещением
-    Queue& operator=(Queue&& other) noexcept {
-        if (this != &other) {
-            // Очищаем свои данные
-            clear();
-            
-            // Забираем данные из other
-            head_ = other.head_;
-            tail_ = other.tail_;
-            size_ = other.size_;
-            
-            // allocator_ не меняем - он привязан к своему memory_resource
-            
-            // Обнуляем other
-            other.head_ = nullptr;
-            other.tail_ = nullptr;
-            other.size_ = 0;
-        }
-        return *this;
-    }
-    
-    // Добавить элемент в конец очереди (копирование)
-    void push(const T& value) {
-        // Выделяем память для нового узла через аллокатор
-        Node* new_node = allocator_.allocate(1);
-        
-        // Конструируем узел в выделенной памяти
-        allocator_.construct(new_node, value);
-        
-        // Добавляем узел в конец списка
-        if (empty()) {
-            head_ = tail_ = new_node;
-        } else {
-            tail_->next = new_node;
-            tail_ = new_node;
-        }
-        
-        ++size_;
-    }
-    
-    // Добавить элемент в конец очереди (перемещение)
-    // Используется для rvalue (временных объектов)
-    void push(T&& value) {
-        Node* new_node = allocator_.allocate(1);
-        allocator_.construct(new_node, std::move(value));
-        
-        if (empty()) {
-            head_ = tail_ = new_node;
-        } else {
-            tail_->next = new_node;
-            tail_ = new_node;
-        }
-        
-        ++size_;
-    }
-    
-    // Удалить первый элемент из очереди
-    void pop() {
-        if (empty()) {
-            throw std::runtime_error("pop from empty queue");
-        }
-        
-        // Сохраняем указатель на удаляемый узел
-        Node* old_head = head_;
-        
-        // Перемещаем head на следующий элемент
-        head_ = head_->next;
-        
-        // Если очередь стала пустой, обнуляем tail
-        if (head_ == nullptr) {
-            tail_ = nullptr;
-        }
-        
-        // Уничтожаем объект (вызывается деструктор T)
-        allocator_.destroy(old_head);
-        
-        // Освобождаем память через аллокатор
-        // Память вернётся в free_blocks_ нашего FixedMemoryResource
-        allocator_.deallocate(old_head, 1);
-        
-        --size_;
-    }
-    
-    // Получить ссылку на первый элемент
-    T& front() {
-        if (empty()) {
-            throw std::runtime_error("front on empty queue");
-        }
-        return head_->data;
-    }
-    
-    const T& front() const {
-        if (empty()) {
-            throw std::runtime_error("front on empty queue");
-        }
-        return head_->data;
-    }
-    
-    // Получить ссылку на последний элемент
-    T& back() {
-        if (empty()) {
-            throw std::runtime_error("back on empty queue");
-        }
-        return tail_->data;
-    }
-    
-    const T& back() const {
-        if (empty()) {
-            throw std::runtime_error("back on empty queue");
-        }
-        return tail_->data;
-    }
-    
-    // Проверка на пустоту
-    bool empty() const noexcept {
-        return size_ == 0;
-    }
-    
-    // Получить размер очереди
-    size_t size() const noexcept {
-        return size_;
-    }
-    
-    // Удалить все элементы
-    void clear() {
-        while (!empty()) {
-            pop();
-        }
-    }
-    
-    // Получить итератор на начало
-    Iterator begin() {
-        return Iterator(head_);
-    }
-    
-    // Получить итератор на конец (за последним элементом)
-    Iterator end() {
-        return Iterator(nullptr);
-    }
-    
-    // Константные версии
-    Iterator begin() const {
-        return Iterator(head_);
-    }
-    
-    Iterator end() const {
-        return Iterator(nullptr);
-    }
-};
-
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "fixed_memory_resource.h"
+#include "slab_memory_resource.h"
+#include "stat_counter.h"
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Счётчики очереди для мониторинга (см. Queue::set_metrics и MetricsExporter)
+// Обновляет поток-владелец очереди, читать можно из любого потока
+struct QueueMetrics {
+    StatCounter depth;      // текущее количество элементов
+    StatCounter pushes;     // всего добавлено
+    StatCounter pops;       // всего извлечено (в том числе clear и discard)
+};
+
+// Состояние очереди в снимке пула - корень снимка (см. Queue::save_snapshot)
+// Адреса - из сохранившего процесса, после загрузки пересчитываются через relocate
+struct QueueSnapshotRoot {
+    const void* head;
+    const void* tail;
+    uint64_t size;
+    uint64_t element_size;
+    uint64_t element_alignment;
+};
+
+// Шаблонный контейнер очередь (FIFO - First In, First Out)
+// Реализован на основе односвязного списка
+// По умолчанию использует polymorphic_allocator: память берётся у любого memory_resource,
+// но каждый узел - это виртуальный вызов do_allocate/do_deallocate
+// Со статически типизированным аллокатором (StaticPoolAllocator, см. static_pool.h)
+// выделение узла встраивается в push целиком
+template<typename T, typename Alloc = std::pmr::polymorphic_allocator<T>>
+class Queue {
+private:
+    // Узел односвязного списка
+    struct Node {
+        T data;           // Данные пользователя
+        Node* next;       // Указатель на следующий узел
+        
+        template<typename... Args>
+        Node(Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
+    };
+    
+    // Указатель на первый элемент очереди (откуда удаляем)
+    Node* head_;
+    
+    // Указатель на последний элемент очереди (куда добавляем)
+    Node* tail_;
+    
+    // Количество элементов в очереди
+    size_t size_;
+    
+    // Аллокатор для выделения памяти под узлы (Alloc, перепривязанный к Node)
+    using NodeAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator allocator_;
+
+    // Счётчики для мониторинга (nullptr - не ведутся)
+    QueueMetrics* metrics_;
+
+    // Пул для пакетного выделения в push_range: ресурс allocator_, если это FixedMemoryResource
+    // Определяется один раз при создании очереди (аллокатор у очереди не меняется)
+    FixedMemoryResource* bulk_memory_;
+
+    static FixedMemoryResource* bulk_memory_of(const NodeAllocator& allocator) {
+        if constexpr (std::is_same_v<NodeAllocator, std::pmr::polymorphic_allocator<Node>>) {
+            return dynamic_cast<FixedMemoryResource*>(allocator.resource());
+        } else {
+            return nullptr;
+        }
+    }
+
+    // Узлов в одном пакете push_range (массив указателей на пакет лежит на стеке)
+    static constexpr size_t kBulkBatch = 128;
+
+    template<typename ForwardIt>
+    void push_range_bulk(FixedMemoryResource& memory, ForwardIt first, ForwardIt last) {
+        auto remaining = static_cast<size_t>(std::distance(first, last));
+        void* blocks[kBulkBatch];
+        while (remaining != 0) {
+            size_t count = std::min(remaining, kBulkBatch);
+            memory.allocate_bulk(blocks, count, sizeof(Node), alignof(Node));
+            for (size_t index = 0; index < count; ++index, ++first) {
+                auto* node = static_cast<Node*>(blocks[index]);
+                try {
+                    NodeTraits::construct(allocator_, node, *first);
+                } catch (...) {
+                    for (size_t rest = count; rest-- > index;) {
+                        memory.deallocate(blocks[rest], sizeof(Node), alignof(Node));
+                    }
+                    if (metrics_) {
+                        metrics_->pushes += index;
+                        metrics_->depth = size_;
+                    }
+                    throw;
+                }
+                if (empty()) {
+                    head_ = tail_ = node;
+                } else {
+                    tail_->next = node;
+                    tail_ = node;
+                }
+                ++size_;
+            }
+            remaining -= count;
+            if (metrics_) {
+                metrics_->pushes += count;
+                metrics_->depth = size_;
+            }
+        }
+    }
+
+public:
+    using allocator_type = Alloc;
+
+    // Размер и выравнивание узла: каждый push выделяет ровно столько памяти
+    // Нужны, чтобы подобрать пул слотов под узлы (см. QueueNodePool)
+    static constexpr size_t node_size = sizeof(Node);
+    static constexpr size_t node_alignment = alignof(Node);
+
+    // Forward-итератор для обхода элементов очереди
+    // Позволяет двигаться только вперёд (односвязный список)
+    class Iterator {
+    private:
+        Node* current_;  // Текущий узел
+        
+    public:
+        // Обязательные typedef для итератора
+        using iterator_category = std::forward_iterator_tag;  // Категория итератора
+        using value_type = T;                                  // Тип элемента
+        using difference_type = std::ptrdiff_t;               // Тип разности
+        using pointer = T*;                                    // Тип указателя
+        using reference = T&;                                  // Тип ссылки
+        
+        // Конструктор итератора
+        explicit Iterator(Node* node = nullptr) : current_(node) {}
+        
+        // Оператор разыменования: получить ссылку на данные
+        reference operator*() const {
+            if (!current_) {
+                throw std::runtime_error("Dereferencing end iterator");
+            }
+            return current_->data;
+        }
+        
+        // Оператор стрелка: доступ к членам объекта
+        pointer operator->() const {
+            if (!current_) {
+                throw std::runtime_error("Dereferencing end iterator");
+            }
+            return &(current_->data);
+        }
+        
+        // Префиксный инкремент: ++it
+        // Перемещает итератор к следующему элементу
+        Iterator& operator++() {
+            if (current_) {
+                current_ = current_->next;
+            }
+            return *this;
+        }
+        
+        // Постфиксный инкремент: it++
+        // Возвращает копию старого состояния, затем инкрементирует
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        
+        // Операторы сравнения
+        bool operator==(const Iterator& other) const {
+            return current_ == other.current_;
+        }
+        
+        bool operator!=(const Iterator& other) const {
+            return current_ != other.current_;
+        }
+    };
+    
+    // Конструктор: создаёт пустую очередь
+    // alloc - аллокатор узлов; для polymorphic_allocator можно передать указатель
+    // на memory_resource, по умолчанию - std::pmr::get_default_resource()
+    explicit Queue(const Alloc& alloc = Alloc())
+        : head_(nullptr), tail_(nullptr), size_(0), allocator_(alloc), metrics_(nullptr),
+          bulk_memory_(bulk_memory_of(allocator_)) {}
+    
+    // Деструктор: освобождает всю память
+    ~Queue() {
+        clear();
+    }
+    
+    // Конструктор копирования: создаёт глубокую копию очереди
+    // Все узлы копируются, создаются новые объекты
+    Queue(const Queue& other)
+        : head_(nullptr), tail_(nullptr), size_(0), allocator_(other.allocator_), metrics_(nullptr),
+          bulk_memory_(other.bulk_memory_) {
+        
+        // Копируем все элементы из other
+        for (Node* current = other.head_; current != nullptr; current = current->next) {
+            push(current->data);
+        }
+    }
+    
+    // Оператор присваивания копированием
+    Queue& operator=(const Queue& other) {
+        if (this != &other) {
+            // Очищаем текущую очередь
+            clear();
+            
+            // Копируем элементы из other
+            for (Node* current = other.head_; current != nullptr; current = current->next) {
+                push(current->data);
+            }
+        }
+        return *this;
+    }
+    
+    // Конструктор перемещения: забирает содержимое из other
+    // other остаётся в валидном, но пустом состоянии
+    Queue(Queue&& other) noexcept
+        : head_(other.head_),
+          tail_(other.tail_),
+          size_(other.size_),
+          allocator_(other.allocator_),
+          metrics_(nullptr),
+          bulk_memory_(other.bulk_memory_) {
+        
+        // Обнуляем other, чтобы он не удалил узлы при уничтожении
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+        if (other.metrics_) {
+            other.metrics_->depth = 0;
+        }
+    }
+    
+    // Оператор присваивания перемещением
+    Queue& operator=(Queue&& other) noexcept {
+        if (this != &other) {
+            // Очищаем свои данные
+            clear();
+            
+            // Забираем данные из other
+            head_ = other.head_;
+            tail_ = other.tail_;
+            size_ = other.size_;
+            
+            // allocator_ не меняем - он привязан к своему memory_resource
+            
+            // Обнуляем other
+            other.head_ = nullptr;
+            other.tail_ = nullptr;
+            other.size_ = 0;
+
+            // Счётчики остаются у своих очередей, меняется только глубина
+            if (metrics_) {
+                metrics_->depth = size_;
+            }
+            if (other.metrics_) {
+                other.metrics_->depth = 0;
+            }
+        }
+        return *this;
+    }
+    
+    // Добавить элемент в конец очереди (копирование)
+    void push(const T& value) {
+        // Выделяем память для нового узла через аллокатор
+        Node* new_node = NodeTraits::allocate(allocator_, 1);
+        
+        // Конструируем узел в выделенной памяти
+        NodeTraits::construct(allocator_, new_node, value);
+        
+        // Добавляем узел в конец списка
+        if (empty()) {
+            head_ = tail_ = new_node;
+        } else {
+            tail_->next = new_node;
+            tail_ = new_node;
+        }
+        
+        ++size_;
+        if (metrics_) {
+            ++metrics_->pushes;
+            metrics_->depth = size_;
+        }
+    }
+    
+    // Добавить элемент в конец очереди (перемещение)
+    // Используется для rvalue (временных объектов)
+    void push(T&& value) {
+        Node* new_node = NodeTraits::allocate(allocator_, 1);
+        NodeTraits::construct(allocator_, new_node, std::move(value));
+        
+        if (empty()) {
+            head_ = tail_ = new_node;
+        } else {
+            tail_->next = new_node;
+            tail_ = new_node;
+        }
+        
+        ++size_;
+        if (metrics_) {
+            ++metrics_->pushes;
+            metrics_->depth = size_;
+        }
+    }
+    
+    // Добавить элементы диапазона [first, last) в конец очереди
+    // Пакетное выделение есть только у FixedMemoryResource (и производных от него ресурсов):
+    // если узлы выделяются через polymorphic_allocator из такого ресурса, а диапазон
+    // многопроходный, память под узлы берётся пакетами (FixedMemoryResource::allocate_bulk) -
+    // один вызов на пакет вместо виртуального вызова на каждый узел, узлы пакета лежат
+    // в пуле подряд, и обход очереди потом идёт по памяти последовательно
+    // С любым другим ресурсом или аллокатором - push по одному элементу
+    // Если конструктор элемента выбросит исключение, уже добавленные элементы остаются в очереди
+    template<typename InputIt>
+    void push_range(InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            if (bulk_memory_) {
+                push_range_bulk(*bulk_memory_, first, last);
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+    // Удалить первый элемент из очереди
+    void pop() {
+        if (empty()) {
+            throw std::runtime_error("pop from empty queue");
+        }
+        
+        // Сохраняем указатель на удаляемый узел
+        Node* old_head = head_;
+        
+        // Перемещаем head на следующий элемент
+        head_ = head_->next;
+        
+        // Если очередь стала пустой, обнуляем tail
+        if (head_ == nullptr) {
+            tail_ = nullptr;
+        }
+        
+        // Уничтожаем объект (вызывается деструктор T)
+        NodeTraits::destroy(allocator_, old_head);
+        
+        // Освобождаем память через аллокатор
+        // Память вернётся в списки свободных блоков нашего FixedMemoryResource
+        NodeTraits::deallocate(allocator_, old_head, 1);
+        
+        --size_;
+        if (metrics_) {
+            ++metrics_->pops;
+            metrics_->depth = size_;
+        }
+    }
+    
+    // Получить ссылку на первый элемент
+    T& front() {
+        if (empty()) {
+            throw std::runtime_error("front on empty queue");
+        }
+        return head_->data;
+    }
+    
+    const T& front() const {
+        if (empty()) {
+            throw std::runtime_error("front on empty queue");
+        }
+        return head_->data;
+    }
+    
+    // Получить ссылку на последний элемент
+    T& back() {
+        if (empty()) {
+            throw std::runtime_error("back on empty queue");
+        }
+        return tail_->data;
+    }
+    
+    const T& back() const {
+        if (empty()) {
+            throw std::runtime_error("back on empty queue");
+        }
+        return tail_->data;
+    }
+    
+    // Проверка на пустоту
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+    
+    // Получить размер очереди
+    size_t size() const noexcept {
+        return size_;
+    }
+    
+    // Удалить все элементы
+    void clear() {
+        while (!empty()) {
+            pop();
+        }
+    }
+    
+    // Быстрое удаление всех элементов без возврата памяти узлов в memory_resource
+    // Для арен: память узлов затем освобождается вся сразу (FixedMemoryResource::release)
+    // Деструкторы элементов вызываются, но для тривиально разрушаемых T
+    // узлы даже не обходятся - очередь опустошается за O(1)
+    void discard() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<Node>) {
+            for (Node* current = head_; current != nullptr;) {
+                Node* next = current->next;
+                NodeTraits::destroy(allocator_, current);
+                current = next;
+            }
+        }
+        if (metrics_) {
+            metrics_->pops += size_;
+            metrics_->depth = 0;
+        }
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
+    }
+    
+    // Подключение счётчиков для мониторинга (nullptr - отключить)
+    // metrics должны жить, пока подключены; глубина сразу принимает текущий размер
+    // Один набор счётчиков - на одну очередь
+    void set_metrics(QueueMetrics* metrics) noexcept {
+        metrics_ = metrics;
+        if (metrics_) {
+            metrics_->depth = size_;
+        }
+    }
+    
+    // Снимок очереди вместе с пулом её узлов (см. FixedMemoryResource::save_snapshot)
+    // Голова, хвост и размер на время записи кладутся в блок пула - корень снимка
+    // Выбрасывает std::invalid_argument, если узлы очереди выделяются не из memory
+    void save_snapshot(FixedMemoryResource& memory, const std::string& path) const {
+        static_assert(std::is_constructible_v<Alloc, FixedMemoryResource*>,
+                      "Queue snapshots need an allocator over FixedMemoryResource");
+        if (!(allocator_ == NodeAllocator(Alloc(&memory)))) {
+            throw std::invalid_argument("Queue nodes are not allocated from this pool");
+        }
+
+        void* block = memory.allocate(sizeof(QueueSnapshotRoot), alignof(QueueSnapshotRoot));
+        auto* root = new (block) QueueSnapshotRoot{head_, tail_, size_, sizeof(T), alignof(T)};
+        try {
+            memory.save_snapshot(path, root);
+        } catch (...) {
+            memory.deallocate(root, sizeof(QueueSnapshotRoot), alignof(QueueSnapshotRoot));
+            throw;
+        }
+        memory.deallocate(root, sizeof(QueueSnapshotRoot), alignof(QueueSnapshotRoot));
+    }
+
+    // Очередь из загруженного снимка (FixedMemoryResource::load_snapshot)
+    // Узлы остаются на своих местах в отображении, пересчитываются только ссылки между ними,
+    // поэтому восстановление - один проход по узлам без копирования элементов
+    // fixup(T&, const FixedMemoryResource&) вызывается для каждого элемента: пересчитать
+    // указатели внутри T в пул через relocate (указатели за пределы пула недействительны)
+    // Корень снимка забирается и освобождается (в том числе при ошибке)
+    // Выбрасывает std::runtime_error, если в снимке нет очереди или цепочка узлов повреждена
+    // (в том числе ссылка за пределы пула), std::invalid_argument, если очередь сохранена
+    // с другим типом элемента
+    // При ошибке узлы, до которых разбор не дошёл, остаются занятыми в пуле
+    template<typename Fixup>
+    static Queue load_snapshot(FixedMemoryResource& memory, Fixup fixup) {
+        static_assert(std::is_constructible_v<Alloc, FixedMemoryResource*>,
+                      "Queue snapshots need an allocator over FixedMemoryResource");
+
+        // Корень освобождается при любом выходе
+        struct RootOwner {
+            FixedMemoryResource& memory;
+            QueueSnapshotRoot* root;
+
+            ~RootOwner() {
+                if (root) {
+                    memory.deallocate(root, sizeof(QueueSnapshotRoot), alignof(QueueSnapshotRoot));
+                }
+            }
+        };
+        RootOwner owner{memory, static_cast<QueueSnapshotRoot*>(memory.take_snapshot_root())};
+        const QueueSnapshotRoot* root = owner.root;
+        if (!root) {
+            throw std::runtime_error("Snapshot does not contain a queue");
+        }
+        if (root->element_size != sizeof(T) || root->element_alignment != alignof(T)) {
+            throw std::invalid_argument("Snapshot queue has a different element type");
+        }
+
+        // Адрес вне пула - тоже повреждённая цепочка
+        auto relocate = [&memory](const void* saved) {
+            try {
+                return static_cast<Node*>(memory.relocate(saved));
+            } catch (const std::invalid_argument&) {
+                throw std::runtime_error("Snapshot queue is damaged");
+            }
+        };
+
+        // Очередь владеет уже обработанными узлами: при ошибке она освободит только их
+        Queue queue{Alloc(&memory)};
+        Node* node = relocate(root->head);
+        queue.head_ = node;
+        for (uint64_t index = 0; index < root->size; ++index) {
+            if (!node) {
+                throw std::runtime_error("Snapshot queue is damaged");
+            }
+            node->next = relocate(node->next);
+            fixup(node->data, std::as_const(memory));
+            queue.tail_ = node;
+            ++queue.size_;
+            node = node->next;
+        }
+        if (node || queue.tail_ != relocate(root->tail)) {
+            throw std::runtime_error("Snapshot queue is damaged");
+        }
+        return queue;
+    }
+
+    // Для элементов без указателей: байты элемента переносятся как есть
+    static Queue load_snapshot(FixedMemoryResource& memory) {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Elements that hold pointers need load_snapshot(memory, fixup)");
+        return load_snapshot(memory, [](T&, const FixedMemoryResource&) {});
+    }
+
+    // Получить итератор на начало
+    Iterator begin() {
+        return Iterator(head_);
+    }
+    
+    // Получить итератор на конец (за последним элементом)
+    Iterator end() {
+        return Iterator(nullptr);
+    }
+    
+    // Константные версии
+    Iterator begin() const {
+        return Iterator(head_);
+    }
+    
+    Iterator end() const {
+        return Iterator(nullptr);
+    }
+};
+
+// Пул слотов под узлы Queue<T>: push и pop обходятся снятием/возвратом головы списка
+// Один пул можно передать нескольким очередям с одним и тем же T
+template<typename T>
+using QueueNodePool = SlabMemoryResource<Queue<T>::node_size, Queue<T>::node_alignment>;
+
+// Пул без обращений к куче под Capacity узлов Queue<T> (см. InlineFixedMemoryResource)
+// Узлы одного размера переиспользуют освобождённые блоки, поэтому в очереди
+// может быть до Capacity элементов одновременно
+template<typename T, size_t Capacity>
+using InlineQueuePool =
+    InlineFixedMemoryResource<Capacity * FixedMemoryResource::block_size_for(Queue<T>::node_size)>;
+
 #endif
\ No newline at end of file
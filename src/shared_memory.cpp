@@ -0,0 +1,561 @@
+#include "shared_memory.h"
+#include "bit_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <climits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#define SHARED_MEMORY_POSIX 1
+#else
+#define SHARED_MEMORY_POSIX 0
+#endif
+
+namespace {
+
+std::string segment_name(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+[[noreturn]] void throw_errno(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+}
+
+SharedMemorySegment::SharedMemorySegment(const std::string& name, SharedMemoryMode mode, size_t size)
+    : name_(segment_name(name)), memory_(nullptr), size_(0), owner_(mode == SharedMemoryMode::Create) {
+#if SHARED_MEMORY_POSIX
+    int flags = owner_ ? O_RDWR | O_CREAT | O_EXCL : O_RDWR;
+    int fd = shm_open(name_.c_str(), flags, 0600);
+    if (fd < 0) {
+        throw_errno("Cannot open shared memory " + name_);
+    }
+
+    if (owner_) {
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            int error = errno;
+            ::close(fd);
+            shm_unlink(name_.c_str());
+            errno = error;
+            throw_errno("Cannot resize shared memory " + name_);
+        }
+        size_ = size;
+    } else {
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            throw_errno("Cannot stat shared memory " + name_);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+    }
+
+    // Сегмент нулевого размера: создатель ещё не задал размер
+    void* memory = size_ != 0 ? mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    int error = errno;
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        if (owner_) {
+            shm_unlink(name_.c_str());
+        }
+        errno = size_ != 0 ? error : EAGAIN;
+        throw_errno("Cannot map shared memory " + name_);
+    }
+    memory_ = memory;
+#else
+    (void)size;
+    throw std::runtime_error("Shared memory is not supported on this platform");
+#endif
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+    close();
+}
+
+SharedMemorySegment::SharedMemorySegment(SharedMemorySegment&& other) noexcept
+    : name_(std::move(other.name_)), memory_(other.memory_), size_(other.size_), owner_(other.owner_) {
+    other.memory_ = nullptr;
+    other.size_ = 0;
+    other.owner_ = false;
+}
+
+SharedMemorySegment& SharedMemorySegment::operator=(SharedMemorySegment&& other) noexcept {
+    if (this != &other) {
+        close();
+        name_ = std::move(other.name_);
+        memory_ = other.memory_;
+        size_ = other.size_;
+        owner_ = other.owner_;
+        other.memory_ = nullptr;
+        other.size_ = 0;
+        other.owner_ = false;
+    }
+    return *this;
+}
+
+bool SharedMemorySegment::remove(const std::string& name) {
+#if SHARED_MEMORY_POSIX
+    return shm_unlink(segment_name(name).c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+void SharedMemorySegment::close() {
+#if SHARED_MEMORY_POSIX
+    if (memory_) {
+        munmap(memory_, size_);
+        memory_ = nullptr;
+    }
+    if (owner_) {
+        shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+#endif
+}
+
+#if SHARED_MEMORY_POSIX
+
+namespace {
+
+constexpr uint64_t kSharedQueueMagic = 0x5545'5551'3542'414c;   // "LAB5QUEU"
+constexpr uint32_t kSharedQueueVersion = 1;
+constexpr uint32_t kInitializing = 0;
+constexpr uint32_t kReady = 1;
+
+// Сколько подключающийся ждёт, пока создатель разметит сегмент
+constexpr auto kAttachTimeout = std::chrono::seconds(2);
+
+// Отметка узла, достижимого от головы, на время восстановления - младший бит поля next
+// (смещения узлов кратны 8, поэтому у настоящих ссылок он нулевой)
+constexpr uint64_t kLinkedMark = 1;
+
+// Часы для сроков ожидания (FUTEX_WAIT_BITSET без флагов считает по ним же)
+constexpr clockid_t kWaitClock = CLOCK_MONOTONIC;
+
+timespec deadline_after(std::chrono::milliseconds timeout) {
+    timespec now;
+    clock_gettime(kWaitClock, &now);
+    long long nanoseconds = now.tv_nsec + (timeout.count() % 1000) * 1000000LL;
+    now.tv_sec += static_cast<time_t>(timeout.count() / 1000 + nanoseconds / 1000000000LL);
+    now.tv_nsec = static_cast<long>(nanoseconds % 1000000000LL);
+    return now;
+}
+
+bool deadline_passed(const timespec& deadline) {
+    timespec now;
+    clock_gettime(kWaitClock, &now);
+    return now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+void check(int result, const char* what) {
+    if (result != 0) {
+        throw std::system_error(result, std::generic_category(), what);
+    }
+}
+
+// Событие в сегменте: уведомление увеличивает sequence, ждущий спит, пока sequence
+// не изменится; waiters - сколько процессов ждут (умерший ждущий лишь добавляет лишний wake)
+struct SharedCondition {
+    std::atomic<uint32_t> sequence;
+    uint32_t waiters;
+};
+
+}
+
+// Заголовок очереди в начале сегмента
+// Смещение 0 - это сам заголовок, поэтому оно же означает "нет узла"
+// Узел: поле next, затем (с выравниванием элемента) данные
+struct SharedQueueCore::Header {
+    uint64_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> state;
+
+    uint64_t element_size;
+    uint64_t element_alignment;
+    uint64_t capacity;
+    uint64_t node_size;
+    uint64_t data_offset;
+    uint64_t nodes_offset;
+
+    pthread_mutex_t mutex;
+    SharedCondition not_empty;
+    SharedCondition not_full;
+
+    // Всё ниже меняется только под mutex
+    uint64_t head;
+    uint64_t tail;
+    uint64_t free_head;
+    uint64_t size;
+    uint64_t attached;
+    uint64_t recoveries;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "The ready flag is shared between processes and must be lock-free");
+
+namespace {
+
+// Раскладка узлов: next и данные, узлы идут подряд после заголовка
+struct NodeLayout {
+    size_t data_offset;
+    size_t node_size;
+};
+
+NodeLayout node_layout(size_t element_size, size_t element_alignment) {
+    size_t alignment = std::max(element_alignment, alignof(uint64_t));
+    size_t data_offset = align_up(sizeof(uint64_t), element_alignment);
+    return {data_offset, align_up(data_offset + element_size, alignment)};
+}
+
+}
+
+size_t SharedQueueCore::required_size(size_t capacity, size_t element_size, size_t element_alignment) {
+    NodeLayout layout = node_layout(element_size, element_alignment);
+    size_t nodes_offset = align_up(sizeof(Header), std::max<size_t>(element_alignment, 64));
+    return nodes_offset + capacity * layout.node_size;
+}
+
+SharedQueueCore::SharedQueueCore(const std::string& name, SharedMemoryMode mode, size_t capacity,
+                                 size_t element_size, size_t element_alignment)
+    : segment_(name, mode,
+               mode == SharedMemoryMode::Create ? required_size(capacity, element_size, element_alignment) : 0),
+      header_(static_cast<Header*>(segment_.data())) {
+    if (mode == SharedMemoryMode::Create) {
+        initialize(capacity, element_size, element_alignment);
+    } else {
+        attach(element_size, element_alignment);
+    }
+}
+
+SharedQueueCore::~SharedQueueCore() {
+    try {
+        lock();
+        --header_->attached;
+        unlock();
+    } catch (const std::exception&) {
+        // Мьютекс недоступен: счётчик подключений просто останется завышенным
+    }
+}
+
+// Разметка нового сегмента; флаг готовности публикуется последним
+void SharedQueueCore::initialize(size_t capacity, size_t element_size, size_t element_alignment) {
+    if (capacity == 0 || element_alignment == 0 || (element_alignment & (element_alignment - 1)) != 0) {
+        throw std::invalid_argument("Invalid shared queue parameters");
+    }
+
+    Header* header = new (segment_.data()) Header();
+    NodeLayout layout = node_layout(element_size, element_alignment);
+    header->magic = kSharedQueueMagic;
+    header->version = kSharedQueueVersion;
+    header->element_size = element_size;
+    header->element_alignment = element_alignment;
+    header->capacity = capacity;
+    header->node_size = layout.node_size;
+    header->data_offset = layout.data_offset;
+    header->nodes_offset = align_up(sizeof(Header), std::max<size_t>(element_alignment, 64));
+
+    pthread_mutexattr_t mutex_attributes;
+    check(pthread_mutexattr_init(&mutex_attributes), "pthread_mutexattr_init");
+    check(pthread_mutexattr_setpshared(&mutex_attributes, PTHREAD_PROCESS_SHARED), "pthread_mutexattr_setpshared");
+#ifdef __linux__
+    check(pthread_mutexattr_setrobust(&mutex_attributes, PTHREAD_MUTEX_ROBUST), "pthread_mutexattr_setrobust");
+#endif
+    check(pthread_mutex_init(&header->mutex, &mutex_attributes), "pthread_mutex_init");
+    pthread_mutexattr_destroy(&mutex_attributes);
+
+    // Все узлы свободны; список идёт по возрастанию адресов
+    header->head = 0;
+    header->tail = 0;
+    header->size = 0;
+    header->free_head = 0;
+    for (size_t index = capacity; index-- > 0;) {
+        uint64_t offset = header->nodes_offset + index * header->node_size;
+        next_of(offset) = header->free_head;
+        header->free_head = offset;
+    }
+    header->attached = 1;
+    header->recoveries = 0;
+
+    header->state.store(kReady, std::memory_order_release);
+}
+
+// Подключение: ждём флага готовности, затем сверяем раскладку
+void SharedQueueCore::attach(size_t element_size, size_t element_alignment) {
+    if (segment_.size() < sizeof(Header)) {
+        throw std::runtime_error("Shared memory " + segment_.name() + " is not a queue");
+    }
+
+    auto give_up = std::chrono::steady_clock::now() + kAttachTimeout;
+    while (header_->state.load(std::memory_order_acquire) != kReady) {
+        if (std::chrono::steady_clock::now() > give_up) {
+            throw std::runtime_error("Shared queue " + segment_.name() + " was not initialized");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (header_->magic != kSharedQueueMagic || header_->version != kSharedQueueVersion ||
+        segment_.size() < header_->nodes_offset + header_->capacity * header_->node_size) {
+        throw std::runtime_error("Shared memory " + segment_.name() + " is not a queue");
+    }
+    if (header_->element_size != element_size || header_->element_alignment != element_alignment) {
+        throw std::invalid_argument("Shared queue element type mismatch");
+    }
+
+    lock();
+    ++header_->attached;
+    unlock();
+}
+
+void SharedQueueCore::push(const void* element) {
+    push_impl(element, nullptr);
+}
+
+bool SharedQueueCore::try_push(const void* element) {
+    std::chrono::milliseconds zero(0);
+    return push_impl(element, &zero);
+}
+
+bool SharedQueueCore::push_for(const void* element, std::chrono::milliseconds timeout) {
+    return push_impl(element, &timeout);
+}
+
+void SharedQueueCore::pop(void* out) {
+    pop_impl(out, nullptr);
+}
+
+bool SharedQueueCore::try_pop(void* out) {
+    std::chrono::milliseconds zero(0);
+    return pop_impl(out, &zero);
+}
+
+bool SharedQueueCore::pop_for(void* out, std::chrono::milliseconds timeout) {
+    return pop_impl(out, &timeout);
+}
+
+// Порядок записей выбран так, чтобы после смерти процесса на любом шаге
+// проход от головы давал согласованную очередь: данные пишутся до того,
+// как узел становится достижим, и читаются до того, как он перестаёт быть достижимым
+bool SharedQueueCore::push_impl(const void* element, const std::chrono::milliseconds* timeout) {
+    struct Unlock {
+        const SharedQueueCore* queue;
+        ~Unlock() { queue->unlock(); }
+    };
+
+    timespec deadline;
+    if (timeout) {
+        deadline = deadline_after(*timeout);
+    }
+
+    lock();
+    Unlock guard{this};
+    while (header_->free_head == 0) {
+        if ((timeout && timeout->count() == 0) || !wait(&header_->not_full, timeout ? &deadline : nullptr)) {
+            return false;
+        }
+    }
+
+    uint64_t node = header_->free_head;
+    header_->free_head = next_of(node);
+    std::memcpy(node_at(node) + header_->data_offset, element, header_->element_size);
+    next_of(node) = 0;
+    if (header_->tail != 0) {
+        next_of(header_->tail) = node;
+    } else {
+        header_->head = node;
+    }
+    header_->tail = node;
+    ++header_->size;
+    notify(&header_->not_empty);
+    return true;
+}
+
+bool SharedQueueCore::pop_impl(void* out, const std::chrono::milliseconds* timeout) {
+    struct Unlock {
+        const SharedQueueCore* queue;
+        ~Unlock() { queue->unlock(); }
+    };
+
+    timespec deadline;
+    if (timeout) {
+        deadline = deadline_after(*timeout);
+    }
+
+    lock();
+    Unlock guard{this};
+    while (header_->head == 0) {
+        if ((timeout && timeout->count() == 0) || !wait(&header_->not_empty, timeout ? &deadline : nullptr)) {
+            return false;
+        }
+    }
+
+    uint64_t node = header_->head;
+    std::memcpy(out, node_at(node) + header_->data_offset, header_->element_size);
+    header_->head = next_of(node);
+    if (header_->head == 0) {
+        header_->tail = 0;
+    }
+    --header_->size;
+    next_of(node) = header_->free_head;
+    header_->free_head = node;
+    notify(&header_->not_full);
+    return true;
+}
+
+size_t SharedQueueCore::size() const {
+    lock();
+    size_t size = header_->size;
+    unlock();
+    return size;
+}
+
+size_t SharedQueueCore::capacity() const {
+    return header_->capacity;
+}
+
+size_t SharedQueueCore::get_attached_count() const {
+    lock();
+    size_t attached = header_->attached;
+    unlock();
+    return attached;
+}
+
+size_t SharedQueueCore::get_recovery_count() const {
+    lock();
+    size_t recoveries = header_->recoveries;
+    unlock();
+    return recoveries;
+}
+
+// EOWNERDEAD: прежний владелец умер, мьютекс захвачен нами, но данные могут быть недописаны
+void SharedQueueCore::lock() const {
+    int result = pthread_mutex_lock(&header_->mutex);
+#ifdef __linux__
+    if (result == EOWNERDEAD) {
+        recover();
+        pthread_mutex_consistent(&header_->mutex);
+        return;
+    }
+#endif
+    check(result, "pthread_mutex_lock");
+}
+
+void SharedQueueCore::unlock() const {
+    pthread_mutex_unlock(&header_->mutex);
+}
+
+// Номер события читается под мьютексом, поэтому уведомление между unlock и сном не теряется:
+// futex не заснёт, если sequence уже изменился
+bool SharedQueueCore::wait(void* condition, const void* deadline) const {
+    auto* event = static_cast<SharedCondition*>(condition);
+    auto* until = static_cast<const timespec*>(deadline);
+    uint32_t observed = event->sequence.load(std::memory_order_relaxed);
+    ++event->waiters;
+    unlock();
+#ifdef __linux__
+    syscall(SYS_futex, &event->sequence, FUTEX_WAIT_BITSET, observed, until, nullptr, FUTEX_BITSET_MATCH_ANY);
+#else
+    // Без futex - опрос с короткими паузами
+    (void)observed;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+    lock();
+    --event->waiters;
+    return event->sequence.load(std::memory_order_relaxed) != observed || !until || !deadline_passed(*until);
+}
+
+// Будятся все ждущие: каждый перепроверяет своё условие под мьютексом
+void SharedQueueCore::notify(void* condition) const {
+    auto* event = static_cast<SharedCondition*>(condition);
+    event->sequence.fetch_add(1, std::memory_order_relaxed);
+#ifdef __linux__
+    if (event->waiters != 0) {
+        syscall(SYS_futex, &event->sequence, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+#endif
+}
+
+// Очередь - это узлы, достижимые от головы (не больше capacity, без циклов),
+// все остальные узлы свободны; размер, хвост и список свободных строятся заново
+// Выполняется под мьютексом в состоянии EOWNERDEAD, поэтому не выделяет память и не бросает:
+// достижимые узлы отмечаются прямо в сегменте битом kLinkedMark в поле next
+void SharedQueueCore::recover() const noexcept {
+    size_t capacity = header_->capacity;
+
+    uint64_t previous = 0;
+    uint64_t node = header_->head;
+    size_t size = 0;
+    while (node != 0) {
+        uint64_t relative = node - header_->nodes_offset;
+        bool valid = node >= header_->nodes_offset && relative % header_->node_size == 0 &&
+                     relative / header_->node_size < capacity && !(next_of(node) & kLinkedMark);
+        if (!valid) {
+            // Испорченная ссылка или цикл: очередь обрывается на предыдущем узле
+            if (previous != 0) {
+                next_of(previous) = kLinkedMark;
+            } else {
+                header_->head = 0;
+            }
+            break;
+        }
+        uint64_t next = next_of(node);
+        next_of(node) = next | kLinkedMark;
+        previous = node;
+        node = next;
+        ++size;
+    }
+
+    header_->tail = previous;
+    header_->size = size;
+    header_->free_head = 0;
+    for (size_t index = capacity; index-- > 0;) {
+        uint64_t offset = header_->nodes_offset + index * header_->node_size;
+        if (next_of(offset) & kLinkedMark) {
+            next_of(offset) &= ~kLinkedMark;
+        } else {
+            next_of(offset) = header_->free_head;
+            header_->free_head = offset;
+        }
+    }
+    ++header_->recoveries;
+
+    // Ожидающие могли пропустить сигнал умершего процесса
+    notify(&header_->not_empty);
+    notify(&header_->not_full);
+}
+
+char* SharedQueueCore::node_at(uint64_t offset) const {
+    return static_cast<char*>(segment_.data()) + offset;
+}
+
+uint64_t& SharedQueueCore::next_of(uint64_t offset) const {
+    return *reinterpret_cast<uint64_t*>(node_at(offset));
+}
+
+#else
+
+SharedQueueCore::SharedQueueCore(const std::string& name, SharedMemoryMode mode, size_t,
+                                 size_t, size_t)
+    : segment_(name, mode, 0), header_(nullptr) {}
+
+SharedQueueCore::~SharedQueueCore() {}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Создать новый именованный сегмент или подключиться к существующему
+enum class SharedMemoryMode {
+    Create,
+    Open
+};
+
+// Именованный сегмент разделяемой памяти POSIX (shm_open + mmap)
+// Имя вида "/lab05_queue" ('/' в начале добавляется, если его нет)
+// Создатель удаляет имя при закрытии: подключённые процессы продолжают работать
+// со своими отображениями, новые подключиться уже не смогут
+// Сегмент может служить памятью пула FixedMemoryResource:
+//   SharedMemorySegment segment("/lab05_pool", SharedMemoryMode::Create, size);
+//   FixedMemoryResourceOptions options;
+//   options.initial_size = segment.size();
+//   options.buffer = segment.data();
+//   FixedMemoryResource memory(options);
+// Служебные данные пула (списки свободных) остаются в объекте ресурса, поэтому
+// выделять из такого пула может только один процесс; для обмена между процессами - SharedQueue
+class SharedMemorySegment {
+private:
+    std::string name_;
+    void* memory_;
+    size_t size_;
+    bool owner_;
+
+public:
+    // Create: сегмент size байт (заполнен нулями), ошибка, если имя уже занято
+    // Open: существующий сегмент, size не используется
+    // Выбрасывает std::runtime_error при ошибке системного вызова
+    SharedMemorySegment(const std::string& name, SharedMemoryMode mode, size_t size = 0);
+
+    // Снимает отображение, создатель удаляет имя
+    ~SharedMemorySegment();
+
+    SharedMemorySegment(const SharedMemorySegment&) = delete;
+    SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+
+    SharedMemorySegment(SharedMemorySegment&& other) noexcept;
+    SharedMemorySegment& operator=(SharedMemorySegment&& other) noexcept;
+
+    // Удаление имени сегмента (например, оставшегося после аварийного завершения создателя)
+    // Возвращает false, если такого сегмента нет
+    static bool remove(const std::string& name);
+
+    void* data() const { return memory_; }
+    size_t size() const { return size_; }
+    const std::string& name() const { return name_; }
+    bool is_owner() const { return owner_; }
+
+private:
+    void close();
+};
+
+// Очередь фиксированной ёмкости в разделяемой памяти для передачи элементов между процессами
+// Узлы, их связи (next), голова и хвост хранятся как смещения от начала сегмента,
+// поэтому каждый процесс может отобразить сегмент по своему адресу
+// Элемент копируется прямо в узел сегмента, без сериализации
+// Синхронизация - разделяемый между процессами мьютекс в сегменте; ожидание - на счётчиках
+// событий (futex на Linux): ждущий процесс не оставляет в сегменте своего состояния,
+// поэтому его смерть не мешает остальным (в отличие от pthread_cond_t)
+// Протокол: создатель размечает сегмент и последним шагом публикует флаг готовности,
+// подключающийся ждёт этот флаг и сверяет размер и выравнивание элемента
+// Мьютекс устойчивый (robust, Linux): если процесс умер, держа его, следующий захвативший
+// восстанавливает очередь - заново проходит список от головы, недостижимые узлы возвращаются
+// в список свободных (элемент, который умерший процесс не успел добавить или забрать целиком,
+// теряется, но очередь остаётся согласованной)
+// Нетипизированное ядро; типизированная обёртка - SharedQueue<T>
+class SharedQueueCore {
+private:
+    struct Header;
+
+    SharedMemorySegment segment_;
+    Header* header_;
+
+public:
+    // Create: новая очередь на capacity элементов
+    // Open: подключение к существующей, capacity берётся из сегмента
+    // Выбрасывает std::runtime_error при системной ошибке или если очередь не стала готовой,
+    // std::invalid_argument, если размер или выравнивание элемента не совпадают
+    SharedQueueCore(const std::string& name, SharedMemoryMode mode, size_t capacity,
+                    size_t element_size, size_t element_alignment);
+
+    // Отключение от очереди
+    ~SharedQueueCore();
+
+    SharedQueueCore(const SharedQueueCore&) = delete;
+    SharedQueueCore& operator=(const SharedQueueCore&) = delete;
+
+    // Добавление копии element_size байт: ждёт свободного узла / не ждёт / ждёт не дольше timeout
+    void push(const void* element);
+    bool try_push(const void* element);
+    bool push_for(const void* element, std::chrono::milliseconds timeout);
+
+    // Извлечение первого элемента в out: ждёт элемента / не ждёт / ждёт не дольше timeout
+    void pop(void* out);
+    bool try_pop(void* out);
+    bool pop_for(void* out, std::chrono::milliseconds timeout);
+
+    size_t size() const;
+    size_t capacity() const;
+
+    // Сколько объектов очереди сейчас подключено (во всех процессах)
+    // Процесс, умерший без отключения, остаётся в счёте
+    size_t get_attached_count() const;
+
+    // Сколько раз очередь восстанавливалась после смерти процесса, державшего мьютекс
+    size_t get_recovery_count() const;
+
+private:
+    // timeout == nullptr - ждать без ограничения
+    bool push_impl(const void* element, const std::chrono::milliseconds* timeout);
+    bool pop_impl(void* out, const std::chrono::milliseconds* timeout);
+
+    void lock() const;
+    void unlock() const;
+
+    // Ожидание события condition (SharedCondition) под мьютексом; false - истёк срок
+    bool wait(void* condition, const void* deadline) const;
+    void notify(void* condition) const;
+
+    // Восстановление после смерти владельца мьютекса (мьютекс захвачен)
+    // Не бросает: иначе мьютекс остался бы несогласованным и захваченным навсегда
+    void recover() const noexcept;
+
+    // Размер сегмента под очередь
+    static size_t required_size(size_t capacity, size_t element_size, size_t element_alignment);
+
+    void initialize(size_t capacity, size_t element_size, size_t element_alignment);
+    void attach(size_t element_size, size_t element_alignment);
+
+    // Узел по смещению и поле next узла
+    char* node_at(uint64_t offset) const;
+    uint64_t& next_of(uint64_t offset) const;
+};
+
+// Типизированная очередь в разделяемой памяти (см. SharedQueueCore)
+// Элементы копируются побайтно, поэтому T должен быть тривиально копируемым
+// и не содержать указателей на память процесса
+template<typename T>
+class SharedQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "SharedQueue elements are copied between processes");
+
+private:
+    SharedQueueCore core_;
+
+public:
+    SharedQueue(const std::string& name, SharedMemoryMode mode, size_t capacity = 0)
+        : core_(name, mode, capacity, sizeof(T), alignof(T)) {}
+
+    void push(const T& value) { core_.push(&value); }
+    bool try_push(const T& value) { return core_.try_push(&value); }
+    bool push_for(const T& value, std::chrono::milliseconds timeout) { return core_.push_for(&value, timeout); }
+
+    void pop(T& out) { core_.pop(&out); }
+    bool try_pop(T& out) { return core_.try_pop(&out); }
+    bool pop_for(T& out, std::chrono::milliseconds timeout) { return core_.pop_for(&out, timeout); }
+
+    size_t size() const { return core_.size(); }
+    bool empty() const { return core_.size() == 0; }
+    size_t capacity() const { return core_.capacity(); }
+    size_t get_attached_count() const { return core_.get_attached_count(); }
+    size_t get_recovery_count() const { return core_.get_recovery_count(); }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef SLAB_MEMORY_RESOURCE_H
+#define SLAB_MEMORY_RESOURCE_H
+
+#include "fixed_memory_resource.h" // FIXED_MEMORY_RESOURCE_CHECKED
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+// Аллокатор объектов одного размера (slab / object pool) поверх фиксированного блока памяти
+// Пул нарезается на одинаковые слоты размером SlotSize с выравниванием SlotAlign,
+// свободные слоты связаны в интрусивный односвязный список
+// Выделение и освобождение - это снятие и возврат головы списка, без заголовков у слотов
+// Подходит для узлов контейнеров, у которых размер известен на этапе компиляции
+// (см. QueueNodePool в queue.h), один пул могут разделять несколько контейнеров
+template<size_t SlotSize, size_t SlotAlign = alignof(std::max_align_t)>
+class SlabMemoryResource : public std::pmr::memory_resource {
+    static_assert(SlotSize > 0, "Slot size must be positive");
+    static_assert((SlotAlign & (SlotAlign - 1)) == 0, "Slot alignment must be a power of two");
+
+private:
+    // Свободный слот хранит указатель на следующий свободный слот в своих данных
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+public:
+    // Выравнивание и размер слота: в слоте должен помещаться узел списка свободных
+    static constexpr size_t kSlotAlignment = std::max(SlotAlign, alignof(FreeSlot));
+    static constexpr size_t kSlotSize =
+        (std::max(SlotSize, sizeof(FreeSlot)) + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+
+private:
+    // Указатель на начало фиксированного блока памяти
+    char* memory_pool_;
+
+    // Количество слотов в пуле
+    size_t slot_count_;
+
+    // Граница нарезки: слоты до неё уже выдавались, после - ещё нет
+    // Пул нарезается лениво, поэтому конструктор не трогает всю память
+    char* bump_;
+
+    // Голова списка свободных слотов
+    FreeSlot* free_list_;
+
+    // Количество активных (занятых) слотов
+    size_t allocated_count_;
+
+public:
+    // Конструктор: выделяет фиксированный блок памяти заданного размера
+    // size - размер блока в байтах (по умолчанию 1 МБ), округляется вниз до целого числа слотов
+    explicit SlabMemoryResource(size_t size = 1024 * 1024)
+        : memory_pool_(nullptr), slot_count_(size / kSlotSize), bump_(nullptr),
+          free_list_(nullptr), allocated_count_(0) {
+        memory_pool_ = static_cast<char*>(
+            ::operator new(slot_count_ * kSlotSize, std::align_val_t{kSlotAlignment}));
+        bump_ = memory_pool_;
+    }
+
+    // Деструктор: освобождает весь блок памяти
+    ~SlabMemoryResource() override {
+        if (allocated_count_ != 0) {
+            std::cout << "Внимание: освобождается память с "
+                      << allocated_count_ << " неосвобождёнными слотами\n";
+        }
+        ::operator delete(memory_pool_, std::align_val_t{kSlotAlignment});
+    }
+
+    // Ресурс уникален: копирование и перемещение запрещены
+    SlabMemoryResource(const SlabMemoryResource&) = delete;
+    SlabMemoryResource& operator=(const SlabMemoryResource&) = delete;
+
+    // Вывод статистики использования памяти
+    void print_stats() const {
+        std::cout << "\nСтатистика использования памяти (slab):\n"
+                  << "Размер слота: " << kSlotSize << " байт\n"
+                  << "Всего слотов: " << slot_count_ << "\n"
+                  << "Занято слотов: " << allocated_count_ << "\n"
+                  << "Нарезано слотов: " << get_carved_count() << "\n\n";
+    }
+
+    // Методы для тестирования
+    size_t get_allocated_count() const { return allocated_count_; }
+    size_t get_capacity() const { return slot_count_; }
+    // Слоты, которые уже выдавались хотя бы раз (свободные из них лежат в списке)
+    size_t get_carved_count() const { return static_cast<size_t>(bump_ - memory_pool_) / kSlotSize; }
+    size_t get_free_bytes() const { return (slot_count_ - allocated_count_) * kSlotSize; }
+    // Внешней фрагментации нет: любой свободный слот подходит под любой запрос
+    double get_fragmentation() const { return 0.0; }
+
+    // Лежит ли ptr в начале уже выданного слота этого пула (занят ли слот, не проверяется)
+    bool owns(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        return p >= memory_pool_ && p < bump_ && static_cast<size_t>(p - memory_pool_) % kSlotSize == 0;
+    }
+
+    // Выделение и возврат слота без виртуального вызова (для StaticPool, см. static_pool.h)
+    // Выделение: голова списка свободных или следующий ненарезанный слот
+    // Запросы больше слота или с большим выравниванием не обслуживаются
+    void* allocate_slot(size_t bytes, size_t alignment) {
+        if (bytes > kSlotSize || alignment > kSlotAlignment) {
+            throw std::bad_alloc();
+        }
+
+        void* slot;
+        if (free_list_) {
+            slot = free_list_;
+            free_list_ = free_list_->next;
+        } else if (bump_ != memory_pool_ + slot_count_ * kSlotSize) {
+            slot = bump_;
+            bump_ += kSlotSize;
+        } else {
+            throw std::bad_alloc();
+        }
+
+        ++allocated_count_;
+        return slot;
+    }
+
+    // Освобождение без проверок: слот становится новой головой списка свободных
+    void release_slot(void* ptr) noexcept {
+        auto* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = free_list_;
+        free_list_ = slot;
+        --allocated_count_;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return allocate_slot(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+#if FIXED_MEMORY_RESOURCE_CHECKED
+        // Без заголовков проверяется только, что ptr - начало уже выданного слота этого пула
+        // (повторное освобождение так не обнаружить)
+        if (!owns(ptr) || bytes > kSlotSize || alignment > kSlotAlignment) {
+            throw std::invalid_argument("Block not allocated by this resource");
+        }
+#else
+        (void)bytes;
+        (void)alignment;
+#endif
+        release_slot(ptr);
+    }
+
+    // Сравнение memory_resource: равны, если это один и тот же объект
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+#endif
\ No newline at end of file
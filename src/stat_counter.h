@@ -0,0 +1,54 @@
+#ifndef STAT_COUNTER_H
+#define STAT_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+
+// Счётчик статистики аллокатора с одним писателем
+// Изменяет его только поток-владелец ресурса (или поток, держащий мьютекс ресурса),
+// а читать можно из любого потока без блокировок
+// Изменение - это relaxed load и store без атомарного read-modify-write:
+// на x86-64 и arm64 оно компилируется в обычные команды, как у простого size_t
+// Поэтому счётчики остаются включёнными всегда
+class StatCounter {
+private:
+    std::atomic<size_t> value_;
+
+public:
+    StatCounter(size_t value = 0) : value_(value) {}
+
+    // Копирование переносит значение (нужно для перемещения ресурсов)
+    StatCounter(const StatCounter& other) : value_(other.get()) {}
+    StatCounter& operator=(const StatCounter& other) {
+        set(other.get());
+        return *this;
+    }
+    StatCounter& operator=(size_t value) {
+        set(value);
+        return *this;
+    }
+
+    size_t get() const { return value_.load(std::memory_order_relaxed); }
+    void set(size_t value) { value_.store(value, std::memory_order_relaxed); }
+    operator size_t() const { return get(); }
+
+    StatCounter& operator+=(size_t delta) {
+        set(get() + delta);
+        return *this;
+    }
+    StatCounter& operator-=(size_t delta) {
+        set(get() - delta);
+        return *this;
+    }
+    StatCounter& operator++() { return *this += 1; }
+    StatCounter& operator--() { return *this -= 1; }
+
+    // Поднять значение до value, если оно больше (отметка максимума)
+    void raise_to(size_t value) {
+        if (value > get()) {
+            set(value);
+        }
+    }
+};
+
+#endif
\ No newline at end of file
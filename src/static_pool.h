@@ -0,0 +1,299 @@
+#ifndef STATIC_POOL_H
+#define STATIC_POOL_H
+
+#include "fixed_memory_resource.h"
+#include "queue.h"
+#include "slab_memory_resource.h"
+#include "stat_counter.h"
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+// Пул со статически заданными свойствами: StaticPool<Strategy, Locking, Stats, Checks>
+// Все свойства - параметры шаблона, поэтому allocate/deallocate вызываются без виртуальных
+// вызовов и встраиваются в место вызова (через StaticPoolAllocator - прямо в Queue::push)
+// вместе с кодом стратегии, если он в заголовке (SlabStrategy; FixedStrategy - см. ниже)
+// Ненужные свойства (блокировка, статистика, проверки) компилируются в пустые функции
+// Для type-erased использования StaticPool остаётся std::pmr::memory_resource
+
+// Стратегии пула: откуда берутся блоки
+// Требования: allocate(bytes, alignment), deallocate(ptr, bytes, alignment), owns(ptr),
+// kSelfChecked - стратегия сама проверяет освобождаемые указатели (тогда проверки пула
+// по умолчанию отключены, см. DefaultPoolChecksFor)
+
+// Слоты одного размера (SlabMemoryResource): выделение - снятие головы списка
+template<size_t SlotSize, size_t SlotAlign = alignof(std::max_align_t)>
+class SlabStrategy {
+private:
+    SlabMemoryResource<SlotSize, SlotAlign> slab_;
+
+public:
+    static constexpr bool kSelfChecked = false;
+
+    explicit SlabStrategy(size_t size = 1024 * 1024) : slab_(size) {}
+
+    void* allocate(size_t bytes, size_t alignment) { return slab_.allocate_slot(bytes, alignment); }
+    void deallocate(void* ptr, size_t, size_t) noexcept { slab_.release_slot(ptr); }
+    bool owns(const void* ptr) const { return slab_.owns(ptr); }
+
+    SlabMemoryResource<SlotSize, SlotAlign>& resource() { return slab_; }
+    const SlabMemoryResource<SlotSize, SlotAlign>& resource() const { return slab_; }
+};
+
+// Блоки произвольного размера (FixedMemoryResource)
+// Ресурс - член стратегии, его динамический тип известен, поэтому компилятор может обойтись
+// без косвенного перехода, но do_allocate/do_deallocate определены в fixed_memory_resource.cpp
+// и не встраиваются: остаётся обычный вызов функции
+// Ресурс сам проверяет указатели (FIXED_MEMORY_RESOURCE_CHECKED) и в усиленной сборке
+// ставит свои контрольные байты, поэтому проверки пула поверх него по умолчанию не нужны
+class FixedStrategy {
+private:
+    FixedMemoryResource fixed_;
+
+public:
+    static constexpr bool kSelfChecked = FIXED_MEMORY_RESOURCE_CHECKED;
+
+    // Аргументы передаются конструктору FixedMemoryResource
+    template<typename... Args>
+    explicit FixedStrategy(Args&&... args) : fixed_(std::forward<Args>(args)...) {}
+
+    void* allocate(size_t bytes, size_t alignment) { return fixed_.allocate(bytes, alignment); }
+    void deallocate(void* ptr, size_t bytes, size_t alignment) { fixed_.deallocate(ptr, bytes, alignment); }
+    bool owns(const void* ptr) const { return fixed_.owns(ptr); }
+
+    FixedMemoryResource& resource() { return fixed_; }
+    const FixedMemoryResource& resource() const { return fixed_; }
+};
+
+// Блокировка: любой тип с lock/unlock (например, std::mutex)
+// NullLock - пул для одного потока, блокировка не стоит ничего
+struct NullLock {
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+
+// Статистика пула
+struct NoPoolStats {
+    void on_allocate(size_t) noexcept {}
+    void on_deallocate(size_t) noexcept {}
+};
+
+// Счётчики выделений и запрошенных байт (читать можно из любого потока)
+struct CountingPoolStats {
+    StatCounter allocations;
+    StatCounter deallocations;
+    StatCounter bytes_in_use;
+    StatCounter peak_bytes_in_use;
+
+    void on_allocate(size_t bytes) noexcept {
+        ++allocations;
+        bytes_in_use += bytes;
+        peak_bytes_in_use.raise_to(bytes_in_use);
+    }
+
+    void on_deallocate(size_t bytes) noexcept {
+        ++deallocations;
+        bytes_in_use -= bytes;
+    }
+};
+
+// Проверки освобождаемых указателей
+// kGuardSize - сколько байт пул добавляет к каждому запросу под контрольные байты
+
+// Без проверок
+struct NoPoolChecks {
+    static constexpr size_t kGuardSize = 0;
+
+    template<typename Strategy>
+    void after_allocate(const Strategy&, void*, size_t) noexcept {}
+    template<typename Strategy>
+    void before_deallocate(const Strategy&, void*, size_t) noexcept {}
+};
+
+// Указатель должен принадлежать пулу (как FIXED_MEMORY_RESOURCE_CHECKED)
+struct OwnershipPoolChecks {
+    static constexpr size_t kGuardSize = 0;
+
+    template<typename Strategy>
+    void after_allocate(const Strategy&, void*, size_t) noexcept {}
+
+    template<typename Strategy>
+    void before_deallocate(const Strategy& strategy, void* ptr, size_t) {
+        if (!strategy.owns(ptr)) {
+            throw std::invalid_argument("Block not allocated by this resource");
+        }
+    }
+};
+
+// Усиленные проверки (как FIXED_MEMORY_RESOURCE_HARDENED): контрольные байты за данными,
+// учёт занятых блоков для обнаружения повторного освобождения,
+// освобождённые данные заливаются узором, чтобы чтение после освобождения было заметно
+// Учёт занятых блоков идёт через хеш-таблицу, поэтому режим только для отладки
+class HardenedPoolChecks {
+private:
+    static constexpr unsigned char kGuardByte = 0xAB;
+    static constexpr unsigned char kFreedByte = 0xDD;
+
+    std::unordered_set<const void*> live_;
+
+public:
+    static constexpr size_t kGuardSize = 8;
+
+    template<typename Strategy>
+    void after_allocate(const Strategy&, void* ptr, size_t bytes) {
+        char* data_end = static_cast<char*>(ptr) + bytes;
+        std::fill(data_end, data_end + kGuardSize, static_cast<char>(kGuardByte));
+        live_.insert(ptr);
+    }
+
+    template<typename Strategy>
+    void before_deallocate(const Strategy& strategy, void* ptr, size_t bytes) {
+        if (!strategy.owns(ptr)) {
+            throw std::invalid_argument("Block not allocated by this resource");
+        }
+        if (live_.find(ptr) == live_.end()) {
+            throw std::invalid_argument("Block is already free");
+        }
+        char* data = static_cast<char*>(ptr);
+        if (!std::all_of(data + bytes, data + bytes + kGuardSize,
+                         [](char c) { return static_cast<unsigned char>(c) == kGuardByte; })) {
+            throw std::runtime_error("Buffer overflow past the end of a block");
+        }
+        live_.erase(ptr);
+        std::fill(data, data + bytes + kGuardSize, static_cast<char>(kFreedByte));
+    }
+};
+
+// Проверки по умолчанию следуют режиму сборки FixedMemoryResource
+using DefaultPoolChecks = std::conditional_t<
+    FIXED_MEMORY_RESOURCE_HARDENED, HardenedPoolChecks,
+    std::conditional_t<FIXED_MEMORY_RESOURCE_CHECKED, OwnershipPoolChecks, NoPoolChecks>>;
+
+// Проверки по умолчанию для стратегии: если стратегия проверяет указатели сама,
+// вторые проверки (и вторые контрольные байты) не добавляются
+template<typename Strategy>
+using DefaultPoolChecksFor = std::conditional_t<Strategy::kSelfChecked, NoPoolChecks, DefaultPoolChecks>;
+
+template<typename Strategy, typename Locking = NullLock, typename Stats = NoPoolStats,
+         typename Checks = DefaultPoolChecksFor<Strategy>>
+class StaticPool final : public std::pmr::memory_resource {
+private:
+    Strategy strategy_;
+    Locking lock_;
+    Stats stats_;
+    Checks checks_;
+
+public:
+    // Аргументы передаются конструктору стратегии (например, размер пула)
+    template<typename... Args>
+    explicit StaticPool(Args&&... args) : strategy_(std::forward<Args>(args)...) {}
+
+    // Пул уникален: копирование и перемещение запрещены
+    StaticPool(const StaticPool&) = delete;
+    StaticPool& operator=(const StaticPool&) = delete;
+
+    // Выделение и освобождение без виртуальных вызовов
+    // Скрывают одноимённые методы memory_resource: через ссылку на StaticPool
+    // вызываются напрямую, через memory_resource - через do_allocate/do_deallocate
+    [[nodiscard]] void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        std::lock_guard<Locking> guard(lock_);
+        void* ptr = strategy_.allocate(bytes + Checks::kGuardSize, alignment);
+        if constexpr (!std::is_same_v<Checks, NoPoolChecks>) {
+            try {
+                checks_.after_allocate(strategy_, ptr, bytes);
+            } catch (...) {
+                strategy_.deallocate(ptr, bytes + Checks::kGuardSize, alignment);
+                throw;
+            }
+        }
+        stats_.on_allocate(bytes);
+        return ptr;
+    }
+
+    void deallocate(void* ptr, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        std::lock_guard<Locking> guard(lock_);
+        checks_.before_deallocate(strategy_, ptr, bytes);
+        strategy_.deallocate(ptr, bytes + Checks::kGuardSize, alignment);
+        stats_.on_deallocate(bytes);
+    }
+
+    const Stats& stats() const { return stats_; }
+    Strategy& strategy() { return strategy_; }
+    const Strategy& strategy() const { return strategy_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Аллокатор в стиле std::allocator поверх StaticPool (или любого пула с теми же
+// невиртуальными allocate/deallocate): тип пула известен, поэтому вызовы встраиваются
+// Как и polymorphic_allocator, неявно создаётся из указателя на пул
+template<typename T, typename Pool>
+class StaticPoolAllocator {
+private:
+    template<typename U, typename OtherPool>
+    friend class StaticPoolAllocator;
+
+    Pool* pool_;
+
+public:
+    using value_type = T;
+
+    StaticPoolAllocator(Pool* pool) noexcept : pool_(pool) {}
+
+    template<typename U>
+    StaticPoolAllocator(const StaticPoolAllocator<U, Pool>& other) noexcept : pool_(other.pool_) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(pool_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        pool_->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    Pool* pool() const noexcept { return pool_; }
+
+    template<typename U>
+    bool operator==(const StaticPoolAllocator<U, Pool>& other) const noexcept {
+        return pool_ == other.pool_;
+    }
+
+    template<typename U>
+    bool operator!=(const StaticPoolAllocator<U, Pool>& other) const noexcept {
+        return pool_ != other.pool_;
+    }
+};
+
+// Пул слотов под узлы Queue<T> со статическими свойствами (слот вмещает и контрольные байты)
+template<typename T, typename Locking = NullLock, typename Stats = NoPoolStats,
+         typename Checks = DefaultPoolChecks>
+using QueueStaticPool =
+    StaticPool<SlabStrategy<Queue<T>::node_size + Checks::kGuardSize, Queue<T>::node_alignment>,
+               Locking, Stats, Checks>;
+
+// Очередь, узлы которой выделяются из пула Pool без виртуальных вызовов
+template<typename T, typename Pool>
+using StaticPoolQueue = Queue<T, StaticPoolAllocator<T, Pool>>;
+
+#endif
\ No newline at end of file
@@ -1,402 +1,3100 @@
-#include <gtest/gtest.h>
-#include "fixed_memory_resource.h"
-#include "queue.h"
-#include <string>
-#include <type_traits>
-
-// Структура для тестирования со сложным типом
-// Содержит несколько полей разных типов
-struct Person {
-    std::string name;
-    int age;
-    double salary;
-    
-    Person() : name(""), age(0), salary(0.0) {}
-    Person(std::string n, int a, double s) : name(std::move(n)), age(a), salary(s) {}
-    
-    bool operator==(const Person& other) const {
-        return name == other.name && age == other.age && salary == other.salary;
-    }
-};
-
-// Набор тестов для FixedMemoryResource
-class FixedMemoryResourceTest : public ::testing::Test {
-protected:
-    FixedMemoryResource* memory_resource;
-    
-    void SetUp() override {
-        memory_resource = new FixedMemoryResource(4096);
-    }
-    
-    void TearDown() override {
-        delete memory_resource;
-    }
-};
-
-TEST_F(FixedMemoryResourceTest, Allocation) {
-    void* ptr = memory_resource->allocate(100);
-    ASSERT_NE(ptr, nullptr);
-    EXPECT_EQ(memory_resource->get_allocated_count(), 1);
-    memory_resource->deallocate(ptr, 100);
-}
-
-TEST_F(FixedMemoryResourceTest, Deallocation) {
-    void* ptr = memory_resource->allocate(100);
-    ASSERT_NE(ptr, nullptr);
-    
-    memory_resource->deallocate(ptr, 100);
-    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
-    EXPECT_EQ(memory_resource->get_free_count(), 1);
-}
-
-TEST_F(FixedMemoryResourceTest, MemoryReuse) {
-    void* ptr1 = memory_resource->allocate(100);
-    size_t offset_after_first = memory_resource->get_current_offset();
-    
-    memory_resource->deallocate(ptr1, 100);
-    
-    void* ptr2 = memory_resource->allocate(100);
-    size_t offset_after_second = memory_resource->get_current_offset();
-    
-    EXPECT_EQ(ptr1, ptr2);
-    EXPECT_EQ(offset_after_first, offset_after_second);
-    
-    memory_resource->deallocate(ptr2, 100);
-}
-
-TEST_F(FixedMemoryResourceTest, OutOfMemory) {
-    EXPECT_THROW({
-        [[maybe_unused]] void* ptr = memory_resource->allocate(5000);
-    }, std::bad_alloc);
-}
-
-TEST_F(FixedMemoryResourceTest, InvalidDeallocation) {
-    int dummy;
-    void* invalid_ptr = &dummy;
-    EXPECT_THROW(memory_resource->deallocate(invalid_ptr, 100), std::invalid_argument);
-}
-
-TEST_F(FixedMemoryResourceTest, MoveConstructor) {
-    void* ptr = memory_resource->allocate(100);
-    size_t original_count = memory_resource->get_allocated_count();
-    
-    FixedMemoryResource moved(std::move(*memory_resource));
-    
-    EXPECT_EQ(moved.get_allocated_count(), original_count);
-    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
-    
-    moved.deallocate(ptr, 100);
-}
-// Набор тестов для Queue с простым типом (int)
-class QueueTest : public ::testing::Test {
-protected:
-    FixedMemoryResource* memory_resource;
-    Queue<int>* queue;
-    
-    void SetUp() override {
-        memory_resource = new FixedMemoryResource(4096);
-        queue = new Queue<int>(memory_resource);
-    }
-    
-    void TearDown() override {
-        delete queue;
-        delete memory_resource;
-    }
-};
-
-// Тест: пустая очередь
-TEST_F(QueueTest, EmptyQueue) {
-    EXPECT_TRUE(queue->empty());
-    EXPECT_EQ(queue->size(), 0);
-}
-
-// Тест: добавление элементов и размер
-TEST_F(QueueTest, PushAndSize) {
-    queue->push(10);
-    EXPECT_FALSE(queue->empty());
-    EXPECT_EQ(queue->size(), 1);
-    
-    queue->push(20);
-    EXPECT_EQ(queue->size(), 2);
-}
-
-// Тест: доступ к первому и последнему элементу
-TEST_F(QueueTest, FrontAndBack) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    EXPECT_EQ(queue->front(), 10);
-    EXPECT_EQ(queue->back(), 30);
-}
-
-// Тест: удаление элементов
-TEST_F(QueueTest, Pop) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    queue->pop();
-    EXPECT_EQ(queue->front(), 20);
-    EXPECT_EQ(queue->size(), 2);
-    
-    queue->pop();
-    EXPECT_EQ(queue->front(), 30);
-    EXPECT_EQ(queue->size(), 1);
-}
-
-// Тест: pop из пустой очереди
-TEST_F(QueueTest, PopEmpty) {
-    EXPECT_THROW(queue->pop(), std::runtime_error);
-}
-
-// Тест: front из пустой очереди
-TEST_F(QueueTest, FrontEmpty) {
-    EXPECT_THROW(queue->front(), std::runtime_error);
-}
-
-// Тест: очистка очереди
-TEST_F(QueueTest, Clear) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    queue->clear();
-    EXPECT_TRUE(queue->empty());
-    EXPECT_EQ(queue->size(), 0);
-}
-
-// Тест: конструктор копирования
-TEST_F(QueueTest, CopyConstructor) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    Queue<int> copied(*queue);
-    
-    EXPECT_EQ(copied.size(), queue->size());
-    EXPECT_EQ(copied.front(), queue->front());
-    EXPECT_EQ(copied.back(), queue->back());
-    
-    // Проверяем независимость копий
-    copied.pop();
-    EXPECT_NE(copied.size(), queue->size());
-}
-
-// Тест: конструктор перемещения
-TEST_F(QueueTest, MoveConstructor) {
-    queue->push(10);
-    queue->push(20);
-    size_t original_size = queue->size();
-    
-    Queue<int> moved(std::move(*queue));
-    
-    EXPECT_EQ(moved.size(), original_size);
-    EXPECT_EQ(queue->size(), 0);
-    EXPECT_TRUE(queue->empty());
-}
-
-// Тест: оператор присваивания копированием
-TEST_F(QueueTest, CopyAssignment) {
-    queue->push(10);
-    queue->push(20);
-    
-    Queue<int> assigned(memory_resource);
-    assigned = *queue;
-    
-    EXPECT_EQ(assigned.size(), queue->size());
-    EXPECT_EQ(assigned.front(), queue->front());
-}
-
-// Тест: оператор присваивания перемещением
-TEST_F(QueueTest, MoveAssignment) {
-    queue->push(10);
-    queue->push(20);
-    size_t original_size = queue->size();
-    
-    Queue<int> assigned(memory_resource);
-    assigned = std::move(*queue);
-    
-    EXPECT_EQ(assigned.size(), original_size);
-    EXPECT_EQ(queue->size(), 0);
-}
-
-// Тест: итератор begin/end
-TEST_F(QueueTest, IteratorBeginEnd) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    auto it = queue->begin();
-    EXPECT_EQ(*it, 10);
-    
-    ++it;
-    EXPECT_EQ(*it, 20);
-    
-    ++it;
-    EXPECT_EQ(*it, 30);
-    
-    ++it;
-    EXPECT_EQ(it, queue->end());
-}
-
-// Тест: range-based for
-TEST_F(QueueTest, IteratorRangeFor) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    int sum = 0;
-    for (const auto& value : *queue) {
-        sum += value;
-    }
-    
-    EXPECT_EQ(sum, 60);
-}
-
-// Тест: модификация через итератор
-TEST_F(QueueTest, IteratorModification) {
-    queue->push(10);
-    queue->push(20);
-    queue->push(30);
-    
-    for (auto it = queue->begin(); it != queue->end(); ++it) {
-        *it *= 2;
-    }
-    
-    EXPECT_EQ(queue->front(), 20);
-    queue->pop();
-    EXPECT_EQ(queue->front(), 40);
-    queue->pop();
-    EXPECT_EQ(queue->front(), 60);
-}
-
-// Тест: постфиксный инкремент итератора
-TEST_F(QueueTest, IteratorPostIncrement) {
-    queue->push(10);
-    queue->push(20);
-    
-    auto it = queue->begin();
-    auto old_it = it++;
-    
-    EXPECT_EQ(*old_it, 10);
-    EXPECT_EQ(*it, 20);
-}
-
-// Тест: сравнение итераторов
-TEST_F(QueueTest, IteratorComparison) {
-    queue->push(10);
-    
-    auto it1 = queue->begin();
-    auto it2 = queue->begin();
-    auto it3 = queue->end();
-    
-    EXPECT_TRUE(it1 == it2);
-    EXPECT_TRUE(it1 != it3);
-    EXPECT_FALSE(it1 == it3);
-}
-
-// Набор тестов для Queue со сложным типом (struct Person)
-class QueueComplexTypeTest : public ::testing::Test {
-protected:
-    FixedMemoryResource* memory_resource;
-    Queue<Person>* queue;
-    
-    void SetUp() override {
-        memory_resource = new FixedMemoryResource(8192);
-        queue = new Queue<Person>(memory_resource);
-    }
-    
-    void TearDown() override {
-        delete queue;
-        delete memory_resource;
-    }
-};
-
-// Тест: добавление и доступ к структуре
-TEST_F(QueueComplexTypeTest, PushAndFront) {
-    Person alice("Alice", 25, 75000.0);
-    queue->push(alice);
-    
-    EXPECT_EQ(queue->front().name, "Alice");
-    EXPECT_EQ(queue->front().age, 25);
-    EXPECT_EQ(queue->front().salary, 75000.0);
-}
-
-// Тест: семантика перемещения
-TEST_F(QueueComplexTypeTest, MoveSemantics) {
-    queue->push(Person("Bob", 30, 90000.0));
-    
-    EXPECT_EQ(queue->front().name, "Bob");
-    EXPECT_EQ(queue->size(), 1);
-}
-
-// Тест: оператор стрелка итератора
-TEST_F(QueueComplexTypeTest, IteratorArrowOperator) {
-    queue->push(Person("Charlie", 35, 120000.0));
-    
-    auto it = queue->begin();
-    EXPECT_EQ(it->name, "Charlie");
-    EXPECT_EQ(it->age, 35);
-}
-
-// Тест: несколько объектов
-TEST_F(QueueComplexTypeTest, MultiplePeople) {
-    queue->push(Person("Alice", 25, 75000.0));
-    queue->push(Person("Bob", 30, 90000.0));
-    queue->push(Person("Charlie", 35, 120000.0));
-    
-    EXPECT_EQ(queue->size(), 3);
-    EXPECT_EQ(queue->front().name, "Alice");
-    EXPECT_EQ(queue->back().name, "Charlie");
-}
-
-// Интеграционный тест: циклическое добавление и удаление
-TEST(MemoryReuseIntegrationTest, CyclicPushPop) {
-    FixedMemoryResource memory(1024);
-    Queue<int> queue(&memory);
-    
-    // Добавляем 5 элементов
-    for (int i = 0; i < 5; ++i) {
-        queue.push(i);
-    }
-    
-    size_t offset_after_first_batch = memory.get_current_offset();
-    
-    // Удаляем 3 элемента
-    for (int i = 0; i < 3; ++i) {
-        queue.pop();
-    }
-    
-    // Добавляем ещё 3 элемента
-    for (int i = 10; i < 13; ++i) {
-        queue.push(i);
-    }
-    
-    size_t offset_after_reuse = memory.get_current_offset();
-    
-    // Проверяем, что offset не изменился (память переиспользована)
-    EXPECT_EQ(offset_after_first_batch, offset_after_reuse);
-}
-
-// Тест: проверка категории итератора
-TEST(IteratorConceptTest, ForwardIteratorRequirements) {
-    FixedMemoryResource memory(1024);
-    Queue<int> queue(&memory);
-    
-    queue.push(10);
-    queue.push(20);
-    
-    auto it = queue.begin();
-    
-    // Проверяем, что категория итератора - forward_iterator_tag
-    EXPECT_TRUE((std::is_same_v<
-        typename std::iterator_traits<decltype(it)>::iterator_category,
-        std::forward_iterator_tag
-    >));
-}
-
-int main(int argc, char** argv) {
-    ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+#include <gtest/gtest.h>
+#include "allocation_trace.h"
+#include "buddy_memory_resource.h"
+#include "concurrent_fixed_memory_resource.h"
+#include "fixed_memory_resource.h"
+#include "growable_buffer.h"
+#include "latency_histogram.h"
+#include "mapped_memory_resource.h"
+#include "metrics_exporter.h"
+#include "queue.h"
+#include "shared_memory.h"
+#include "static_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define LAB05_TEST_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define LAB05_TEST_ASAN 1
+#endif
+#endif
+
+#ifdef LAB05_TEST_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+// Счётчик вызовов глобального operator new: так тесты проверяют, что пул не обращается к куче
+std::atomic<size_t> g_operator_new_calls{0};
+
+void* operator new(size_t size) {
+    ++g_operator_new_calls;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC после встраивания видит free для памяти из operator new и предупреждает о несоответствии,
+// хотя здесь это одна пара malloc/free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Структура для тестирования со сложным типом
+// Содержит несколько полей разных типов
+struct Person {
+    std::string name;
+    int age;
+    double salary;
+    
+    Person() : name(""), age(0), salary(0.0) {}
+    Person(std::string n, int a, double s) : name(std::move(n)), age(a), salary(s) {}
+    
+    bool operator==(const Person& other) const {
+        return name == other.name && age == other.age && salary == other.salary;
+    }
+};
+
+// Набор тестов для FixedMemoryResource
+class FixedMemoryResourceTest : public ::testing::Test {
+protected:
+    FixedMemoryResource* memory_resource;
+    
+    void SetUp() override {
+        memory_resource = new FixedMemoryResource(4096);
+    }
+    
+    void TearDown() override {
+        delete memory_resource;
+    }
+};
+
+TEST_F(FixedMemoryResourceTest, Allocation) {
+    void* ptr = memory_resource->allocate(100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 1);
+    memory_resource->deallocate(ptr, 100);
+}
+
+TEST_F(FixedMemoryResourceTest, Deallocation) {
+    void* ptr = memory_resource->allocate(100);
+    ASSERT_NE(ptr, nullptr);
+    
+    memory_resource->deallocate(ptr, 100);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
+
+    // Блок был последним в пуле: смещение откатывается, список свободных не нужен
+    EXPECT_EQ(memory_resource->get_free_count(), 0);
+    EXPECT_EQ(memory_resource->get_current_offset(), 0);
+}
+
+TEST_F(FixedMemoryResourceTest, MemoryReuse) {
+    void* ptr1 = memory_resource->allocate(100);
+    size_t offset_after_first = memory_resource->get_current_offset();
+    
+    memory_resource->deallocate(ptr1, 100);
+    
+    void* ptr2 = memory_resource->allocate(100);
+    size_t offset_after_second = memory_resource->get_current_offset();
+    
+    EXPECT_EQ(ptr1, ptr2);
+    EXPECT_EQ(offset_after_first, offset_after_second);
+    
+    memory_resource->deallocate(ptr2, 100);
+}
+
+TEST_F(FixedMemoryResourceTest, OutOfMemory) {
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory_resource->allocate(5000);
+    }, std::bad_alloc);
+}
+
+// Тест: запрос, полный размер блока которого не помещается в поле размера, отклоняется
+TEST_F(FixedMemoryResourceTest, HugeRequestRejected) {
+    // volatile: иначе компилятор предупреждает о заведомо огромном размере
+    volatile size_t huge = SIZE_MAX - 8;
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory_resource->allocate(huge, 16);
+    }, std::bad_alloc);
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory_resource->allocate(size_t{1} << 48);
+    }, std::bad_alloc);
+    void* blocks[2];
+    EXPECT_THROW(memory_resource->allocate_bulk(blocks, 2, SIZE_MAX / 2), std::bad_alloc);
+    EXPECT_EQ(memory_resource->get_current_offset(), 0);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
+    EXPECT_EQ(memory_resource->stats().failed_allocations, 4);
+}
+
+TEST_F(FixedMemoryResourceTest, InvalidDeallocation) {
+    int dummy;
+    void* invalid_ptr = &dummy;
+    EXPECT_THROW(memory_resource->deallocate(invalid_ptr, 100), std::invalid_argument);
+}
+
+TEST_F(FixedMemoryResourceTest, MoveConstructor) {
+    void* ptr = memory_resource->allocate(100);
+    size_t original_count = memory_resource->get_allocated_count();
+    
+    FixedMemoryResource moved(std::move(*memory_resource));
+    
+    EXPECT_EQ(moved.get_allocated_count(), original_count);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
+    
+    moved.deallocate(ptr, 100);
+}
+
+// Тест: выделение с повышенным выравниванием
+TEST_F(FixedMemoryResourceTest, OverAlignedAllocation) {
+    void* small = memory_resource->allocate(8);
+    void* aligned = memory_resource->allocate(64, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 2);
+
+    memory_resource->deallocate(aligned, 64, 64);
+    memory_resource->deallocate(small, 8);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 0);
+}
+
+// Тест: блоки разных размеров переиспользуются из своих размерных классов
+TEST_F(FixedMemoryResourceTest, SizeClassReuse) {
+    // Между блоками оставляем занятые блоки, чтобы свободные не сливались
+    void* small = memory_resource->allocate(16);
+    void* guard1 = memory_resource->allocate(16);
+    void* medium = memory_resource->allocate(200);
+    void* guard2 = memory_resource->allocate(16);
+    void* large = memory_resource->allocate(1000);
+    void* guard3 = memory_resource->allocate(16);
+    size_t offset = memory_resource->get_current_offset();
+
+    memory_resource->deallocate(small, 16);
+    memory_resource->deallocate(medium, 200);
+    memory_resource->deallocate(large, 1000);
+    EXPECT_EQ(memory_resource->get_free_count(), 3);
+
+    EXPECT_EQ(memory_resource->allocate(1000), large);
+    EXPECT_EQ(memory_resource->allocate(200), medium);
+    EXPECT_EQ(memory_resource->allocate(16), small);
+    EXPECT_EQ(memory_resource->get_free_count(), 0);
+    EXPECT_EQ(memory_resource->get_current_offset(), offset);
+
+    memory_resource->deallocate(small, 16);
+    memory_resource->deallocate(medium, 200);
+    memory_resource->deallocate(large, 1000);
+    memory_resource->deallocate(guard1, 16);
+    memory_resource->deallocate(guard2, 16);
+    memory_resource->deallocate(guard3, 16);
+}
+
+// Тест: при пустом своём классе используется блок из старшего класса
+TEST_F(FixedMemoryResourceTest, LargerClassFallback) {
+    void* large = memory_resource->allocate(500);
+    void* guard = memory_resource->allocate(16);
+    memory_resource->deallocate(large, 500);
+
+    size_t offset = memory_resource->get_current_offset();
+    void* small = memory_resource->allocate(24);
+    EXPECT_EQ(small, large);
+    EXPECT_EQ(memory_resource->get_current_offset(), offset);
+
+    memory_resource->deallocate(small, 24);
+    memory_resource->deallocate(guard, 16);
+}
+
+// Тест: соседние свободные блоки сливаются в один
+TEST_F(FixedMemoryResourceTest, Coalescing) {
+    void* a = memory_resource->allocate(100);
+    void* b = memory_resource->allocate(100);
+    void* c = memory_resource->allocate(100);
+    void* guard = memory_resource->allocate(16);
+
+    memory_resource->deallocate(a, 100);
+    memory_resource->deallocate(c, 100);
+    EXPECT_EQ(memory_resource->get_free_count(), 2);
+
+    // b сливается с обоими соседями
+    memory_resource->deallocate(b, 100);
+    EXPECT_EQ(memory_resource->get_free_count(), 1);
+
+    // Объединённый блок вмещает запрос, который не влез бы ни в один из исходных
+    size_t offset = memory_resource->get_current_offset();
+    void* big = memory_resource->allocate(300);
+    EXPECT_EQ(big, a);
+    EXPECT_EQ(memory_resource->get_current_offset(), offset);
+
+    memory_resource->deallocate(big, 300);
+    memory_resource->deallocate(guard, 16);
+}
+
+// Тест: смешанная нагрузка не фрагментирует пул до отказа
+TEST(FragmentationTest, MixedWorkloadSoak) {
+    FixedMemoryResource memory(64 * 1024);
+    std::vector<std::pair<void*, size_t>> live;
+    uint32_t seed = 12345;
+    auto next_random = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    for (int step = 0; step < 20000; ++step) {
+        if (live.size() < 64 && (live.empty() || next_random() % 2 == 0)) {
+            size_t bytes = 8 + next_random() % 400;
+            live.emplace_back(memory.allocate(bytes), bytes);
+        } else {
+            size_t index = next_random() % live.size();
+            memory.deallocate(live[index].first, live[index].second);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (auto& [ptr, bytes] : live) {
+        memory.deallocate(ptr, bytes);
+    }
+
+    // После освобождения всего пула свободная память снова непрерывна
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_LE(memory.get_free_count(), 1);
+    EXPECT_DOUBLE_EQ(memory.get_fragmentation(), 0.0);
+    EXPECT_EQ(memory.get_largest_free_block(), memory.get_free_bytes());
+}
+
+// Тест: освобождённый блок 4 КБ обслуживает много мелких узлов очереди
+TEST(BlockSplittingTest, LargeFreeBlockServesQueueNodes) {
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    GTEST_SKIP() << "Exact block sizes differ with guard bytes";
+#endif
+    FixedMemoryResource memory(16 * 1024);
+    void* large = memory.allocate(4096);
+    void* guard = memory.allocate(16);
+    memory.deallocate(large, 4096);
+
+    size_t offset = memory.get_current_offset();
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(memory.get_current_offset(), offset);
+        EXPECT_EQ(&queue.front(), large);
+    }
+
+    memory.deallocate(guard, 16);
+}
+
+// Тест: выровненные данные размещаются внутри большего свободного блока
+TEST(BlockSplittingTest, AlignedPlacementInsideFreeBlock) {
+    // Пул во внешнем буфере с известным выравниванием: данные первого блока лежат
+    // по адресу base + 16, то есть заведомо не выровнены на 256
+    alignas(256) unsigned char buffer[16 * 1024];
+    FixedMemoryResourceOptions options;
+    options.initial_size = sizeof(buffer);
+    options.buffer = buffer;
+    FixedMemoryResource memory(options);
+    void* large = memory.allocate(1024);
+    ASSERT_NE(reinterpret_cast<uintptr_t>(large) % 256, 0u);
+    void* guard = memory.allocate(16);
+    memory.deallocate(large, 1024);
+
+    size_t offset = memory.get_current_offset();
+    void* aligned = memory.allocate(64, 256);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 256, 0u);
+    EXPECT_GT(aligned, large);
+    EXPECT_LT(aligned, static_cast<void*>(static_cast<char*>(large) + 1024));
+    EXPECT_EQ(memory.get_current_offset(), offset);
+
+    // Отступ перед блоком и хвост остались в пуле
+    EXPECT_EQ(memory.get_free_count(), 2);
+
+    memory.deallocate(aligned, 64, 256);
+    EXPECT_EQ(memory.get_free_count(), 1);
+    memory.deallocate(guard, 16);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: учёт внутренней фрагментации
+TEST(BlockSplittingTest, InternalFragmentation) {
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    GTEST_SKIP() << "Exact block sizes differ with guard bytes";
+#endif
+    FixedMemoryResource memory(4096);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 0);
+
+    // 20 байт занимают 32 байта данных блока
+    void* a = memory.allocate(20);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 12);
+
+    void* b = memory.allocate(32);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 12);
+
+    memory.deallocate(a, 20);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 0);
+    memory.deallocate(b, 32);
+}
+
+// Тест: освобождение в порядке LIFO откатывает смещение без списков свободных
+TEST_F(FixedMemoryResourceTest, TopRetraction) {
+    void* a = memory_resource->allocate(64);
+    size_t offset_after_a = memory_resource->get_current_offset();
+    void* b = memory_resource->allocate(64);
+    void* c = memory_resource->allocate(64);
+
+    memory_resource->deallocate(c, 64);
+    memory_resource->deallocate(b, 64);
+    EXPECT_EQ(memory_resource->get_current_offset(), offset_after_a);
+    EXPECT_EQ(memory_resource->get_free_count(), 0);
+
+    memory_resource->deallocate(a, 64);
+    EXPECT_EQ(memory_resource->get_current_offset(), 0);
+}
+
+// Тест: свободные блоки, касающиеся вершины, поглощаются при её откате
+TEST_F(FixedMemoryResourceTest, TopAbsorbsFreeNeighbours) {
+    void* a = memory_resource->allocate(64);
+    size_t offset_after_a = memory_resource->get_current_offset();
+    void* b = memory_resource->allocate(64);
+    void* c = memory_resource->allocate(64);
+
+    memory_resource->deallocate(b, 64);
+    EXPECT_EQ(memory_resource->get_free_count(), 1);
+
+    memory_resource->deallocate(c, 64);
+    EXPECT_EQ(memory_resource->get_free_count(), 0);
+    EXPECT_EQ(memory_resource->get_current_offset(), offset_after_a);
+
+    memory_resource->deallocate(a, 64);
+}
+
+// Тест: временная копия очереди не оставляет следов в пуле
+TEST(MemoryReuseIntegrationTest, TemporaryCopyRetracts) {
+    FixedMemoryResource memory(4096);
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 5; ++i) {
+        queue.push(i);
+    }
+    size_t offset = memory.get_current_offset();
+
+    {
+        Queue<int> copy(queue);
+        EXPECT_GT(memory.get_current_offset(), offset);
+    }
+
+    EXPECT_EQ(memory.get_current_offset(), offset);
+    EXPECT_EQ(memory.get_free_count(), 0);
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: повторное освобождение блока обнаруживается по заголовку
+TEST_F(FixedMemoryResourceTest, DoubleDeallocation) {
+    void* ptr = memory_resource->allocate(32);
+    void* other = memory_resource->allocate(32);
+    memory_resource->deallocate(ptr, 32);
+    EXPECT_THROW(memory_resource->deallocate(ptr, 32), std::invalid_argument);
+    memory_resource->deallocate(other, 32);
+}
+
+// Тест: указатель в середину занятого блока отвергается
+TEST_F(FixedMemoryResourceTest, InteriorPointerDeallocation) {
+    void* ptr = memory_resource->allocate(128);
+    void* interior = static_cast<char*>(ptr) + 64;
+    EXPECT_THROW(memory_resource->deallocate(interior, 16), std::invalid_argument);
+    EXPECT_EQ(memory_resource->get_allocated_count(), 1);
+    memory_resource->deallocate(ptr, 128);
+}
+#endif
+// Набор тестов для Queue с простым типом (int)
+class QueueTest : public ::testing::Test {
+protected:
+    FixedMemoryResource* memory_resource;
+    Queue<int>* queue;
+    
+    void SetUp() override {
+        memory_resource = new FixedMemoryResource(4096);
+        queue = new Queue<int>(memory_resource);
+    }
+    
+    void TearDown() override {
+        delete queue;
+        delete memory_resource;
+    }
+};
+
+// Тест: пустая очередь
+TEST_F(QueueTest, EmptyQueue) {
+    EXPECT_TRUE(queue->empty());
+    EXPECT_EQ(queue->size(), 0);
+}
+
+// Тест: добавление элементов и размер
+TEST_F(QueueTest, PushAndSize) {
+    queue->push(10);
+    EXPECT_FALSE(queue->empty());
+    EXPECT_EQ(queue->size(), 1);
+    
+    queue->push(20);
+    EXPECT_EQ(queue->size(), 2);
+}
+
+// Тест: доступ к первому и последнему элементу
+TEST_F(QueueTest, FrontAndBack) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    EXPECT_EQ(queue->front(), 10);
+    EXPECT_EQ(queue->back(), 30);
+}
+
+// Тест: удаление элементов
+TEST_F(QueueTest, Pop) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    queue->pop();
+    EXPECT_EQ(queue->front(), 20);
+    EXPECT_EQ(queue->size(), 2);
+    
+    queue->pop();
+    EXPECT_EQ(queue->front(), 30);
+    EXPECT_EQ(queue->size(), 1);
+}
+
+// Тест: pop из пустой очереди
+TEST_F(QueueTest, PopEmpty) {
+    EXPECT_THROW(queue->pop(), std::runtime_error);
+}
+
+// Тест: front из пустой очереди
+TEST_F(QueueTest, FrontEmpty) {
+    EXPECT_THROW(queue->front(), std::runtime_error);
+}
+
+// Тест: очистка очереди
+TEST_F(QueueTest, Clear) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    queue->clear();
+    EXPECT_TRUE(queue->empty());
+    EXPECT_EQ(queue->size(), 0);
+}
+
+// Тест: конструктор копирования
+TEST_F(QueueTest, CopyConstructor) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    Queue<int> copied(*queue);
+    
+    EXPECT_EQ(copied.size(), queue->size());
+    EXPECT_EQ(copied.front(), queue->front());
+    EXPECT_EQ(copied.back(), queue->back());
+    
+    // Проверяем независимость копий
+    copied.pop();
+    EXPECT_NE(copied.size(), queue->size());
+}
+
+// Тест: конструктор перемещения
+TEST_F(QueueTest, MoveConstructor) {
+    queue->push(10);
+    queue->push(20);
+    size_t original_size = queue->size();
+    
+    Queue<int> moved(std::move(*queue));
+    
+    EXPECT_EQ(moved.size(), original_size);
+    EXPECT_EQ(queue->size(), 0);
+    EXPECT_TRUE(queue->empty());
+}
+
+// Тест: оператор присваивания копированием
+TEST_F(QueueTest, CopyAssignment) {
+    queue->push(10);
+    queue->push(20);
+    
+    Queue<int> assigned(memory_resource);
+    assigned = *queue;
+    
+    EXPECT_EQ(assigned.size(), queue->size());
+    EXPECT_EQ(assigned.front(), queue->front());
+}
+
+// Тест: оператор присваивания перемещением
+TEST_F(QueueTest, MoveAssignment) {
+    queue->push(10);
+    queue->push(20);
+    size_t original_size = queue->size();
+    
+    Queue<int> assigned(memory_resource);
+    assigned = std::move(*queue);
+    
+    EXPECT_EQ(assigned.size(), original_size);
+    EXPECT_EQ(queue->size(), 0);
+}
+
+// Тест: итератор begin/end
+TEST_F(QueueTest, IteratorBeginEnd) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    auto it = queue->begin();
+    EXPECT_EQ(*it, 10);
+    
+    ++it;
+    EXPECT_EQ(*it, 20);
+    
+    ++it;
+    EXPECT_EQ(*it, 30);
+    
+    ++it;
+    EXPECT_EQ(it, queue->end());
+}
+
+// Тест: range-based for
+TEST_F(QueueTest, IteratorRangeFor) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    int sum = 0;
+    for (const auto& value : *queue) {
+        sum += value;
+    }
+    
+    EXPECT_EQ(sum, 60);
+}
+
+// Тест: модификация через итератор
+TEST_F(QueueTest, IteratorModification) {
+    queue->push(10);
+    queue->push(20);
+    queue->push(30);
+    
+    for (auto it = queue->begin(); it != queue->end(); ++it) {
+        *it *= 2;
+    }
+    
+    EXPECT_EQ(queue->front(), 20);
+    queue->pop();
+    EXPECT_EQ(queue->front(), 40);
+    queue->pop();
+    EXPECT_EQ(queue->front(), 60);
+}
+
+// Тест: постфиксный инкремент итератора
+TEST_F(QueueTest, IteratorPostIncrement) {
+    queue->push(10);
+    queue->push(20);
+    
+    auto it = queue->begin();
+    auto old_it = it++;
+    
+    EXPECT_EQ(*old_it, 10);
+    EXPECT_EQ(*it, 20);
+}
+
+// Тест: сравнение итераторов
+TEST_F(QueueTest, IteratorComparison) {
+    queue->push(10);
+    
+    auto it1 = queue->begin();
+    auto it2 = queue->begin();
+    auto it3 = queue->end();
+    
+    EXPECT_TRUE(it1 == it2);
+    EXPECT_TRUE(it1 != it3);
+    EXPECT_FALSE(it1 == it3);
+}
+
+// Набор тестов для Queue со сложным типом (struct Person)
+class QueueComplexTypeTest : public ::testing::Test {
+protected:
+    FixedMemoryResource* memory_resource;
+    Queue<Person>* queue;
+    
+    void SetUp() override {
+        memory_resource = new FixedMemoryResource(8192);
+        queue = new Queue<Person>(memory_resource);
+    }
+    
+    void TearDown() override {
+        delete queue;
+        delete memory_resource;
+    }
+};
+
+// Тест: добавление и доступ к структуре
+TEST_F(QueueComplexTypeTest, PushAndFront) {
+    Person alice("Alice", 25, 75000.0);
+    queue->push(alice);
+    
+    EXPECT_EQ(queue->front().name, "Alice");
+    EXPECT_EQ(queue->front().age, 25);
+    EXPECT_EQ(queue->front().salary, 75000.0);
+}
+
+// Тест: семантика перемещения
+TEST_F(QueueComplexTypeTest, MoveSemantics) {
+    queue->push(Person("Bob", 30, 90000.0));
+    
+    EXPECT_EQ(queue->front().name, "Bob");
+    EXPECT_EQ(queue->size(), 1);
+}
+
+// Тест: оператор стрелка итератора
+TEST_F(QueueComplexTypeTest, IteratorArrowOperator) {
+    queue->push(Person("Charlie", 35, 120000.0));
+    
+    auto it = queue->begin();
+    EXPECT_EQ(it->name, "Charlie");
+    EXPECT_EQ(it->age, 35);
+}
+
+// Тест: несколько объектов
+TEST_F(QueueComplexTypeTest, MultiplePeople) {
+    queue->push(Person("Alice", 25, 75000.0));
+    queue->push(Person("Bob", 30, 90000.0));
+    queue->push(Person("Charlie", 35, 120000.0));
+    
+    EXPECT_EQ(queue->size(), 3);
+    EXPECT_EQ(queue->front().name, "Alice");
+    EXPECT_EQ(queue->back().name, "Charlie");
+}
+
+// Интеграционный тест: циклическое добавление и удаление
+TEST(MemoryReuseIntegrationTest, CyclicPushPop) {
+    FixedMemoryResource memory(1024);
+    Queue<int> queue(&memory);
+    
+    // Добавляем 5 элементов
+    for (int i = 0; i < 5; ++i) {
+        queue.push(i);
+    }
+    
+    size_t offset_after_first_batch = memory.get_current_offset();
+    
+    // Удаляем 3 элемента
+    for (int i = 0; i < 3; ++i) {
+        queue.pop();
+    }
+    
+    // Добавляем ещё 3 элемента
+    for (int i = 10; i < 13; ++i) {
+        queue.push(i);
+    }
+    
+    size_t offset_after_reuse = memory.get_current_offset();
+    
+    // Проверяем, что offset не изменился (память переиспользована)
+    EXPECT_EQ(offset_after_first_batch, offset_after_reuse);
+}
+
+// Тест: проверка категории итератора
+TEST(IteratorConceptTest, ForwardIteratorRequirements) {
+    FixedMemoryResource memory(1024);
+    Queue<int> queue(&memory);
+    
+    queue.push(10);
+    queue.push(20);
+    
+    auto it = queue.begin();
+    
+    // Проверяем, что категория итератора - forward_iterator_tag
+    EXPECT_TRUE((std::is_same_v<
+        typename std::iterator_traits<decltype(it)>::iterator_category,
+        std::forward_iterator_tag
+    >));
+}
+
+// Набор тестов, общих для всех стратегий поиска свободных блоков
+class AllocationStrategyTest : public ::testing::TestWithParam<AllocationStrategy> {};
+
+// Тест: очередь работает поверх любой стратегии без изменений
+TEST_P(AllocationStrategyTest, QueueWorksUnchanged) {
+    FixedMemoryResource memory(16 * 1024, GetParam());
+    EXPECT_EQ(memory.get_strategy(), GetParam());
+
+    Queue<Person> queue(&memory);
+    for (int i = 0; i < 50; ++i) {
+        queue.push(Person("Person " + std::to_string(i), i, i * 1000.0));
+    }
+    for (int i = 0; i < 25; ++i) {
+        queue.pop();
+    }
+    for (int i = 50; i < 75; ++i) {
+        queue.push(Person("Person " + std::to_string(i), i, i * 1000.0));
+    }
+
+    int expected = 25;
+    for (const auto& person : queue) {
+        EXPECT_EQ(person.age, expected++);
+    }
+    EXPECT_EQ(queue.size(), 50);
+}
+
+// Тест: освобождённые блоки переиспользуются без роста смещения
+TEST_P(AllocationStrategyTest, ReuseWithoutGrowth) {
+    FixedMemoryResource memory(64 * 1024, GetParam());
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t bytes : {16, 48, 200, 700, 1500, 5000}) {
+        blocks.emplace_back(memory.allocate(bytes), bytes);
+        [[maybe_unused]] void* guard = memory.allocate(16);
+    }
+    size_t offset = memory.get_current_offset();
+
+    for (auto& [ptr, bytes] : blocks) {
+        memory.deallocate(ptr, bytes);
+    }
+    for (auto& [ptr, bytes] : blocks) {
+        ptr = memory.allocate(bytes);
+    }
+    EXPECT_EQ(memory.get_current_offset(), offset);
+}
+
+// Тест: случайная нагрузка возвращает пул в исходное состояние
+TEST_P(AllocationStrategyTest, SoakReturnsToEmpty) {
+    FixedMemoryResource memory(512 * 1024, GetParam());
+    std::vector<std::pair<void*, size_t>> live;
+    uint32_t seed = 777;
+    auto next_random = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    for (int step = 0; step < 50000; ++step) {
+        if (live.size() < 128 && (live.empty() || next_random() % 2 == 0)) {
+            size_t bytes = 1 + next_random() % 2048;
+            size_t alignment = next_random() % 8 == 0 ? 64 : alignof(std::max_align_t);
+            void* ptr = memory.allocate(bytes, alignment);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0u);
+            live.emplace_back(ptr, bytes);
+        } else {
+            size_t index = next_random() % live.size();
+            memory.deallocate(live[index].first, live[index].second);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (auto& [ptr, bytes] : live) {
+        memory.deallocate(ptr, bytes);
+    }
+
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_free_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Strategies, AllocationStrategyTest,
+                         ::testing::Values(AllocationStrategy::SegregatedFit,
+                                           AllocationStrategy::Tlsf),
+                         [](const ::testing::TestParamInfo<AllocationStrategy>& info) {
+                             return info.param == AllocationStrategy::Tlsf ? "Tlsf" : "SegregatedFit";
+                         });
+
+// Тест: TLSF выбирает ближайший по размеру блок, а не первый попавшийся
+TEST(TlsfTest, GoodFit) {
+    FixedMemoryResource memory(64 * 1024, AllocationStrategy::Tlsf);
+    void* small = memory.allocate(1000);
+    [[maybe_unused]] void* guard1 = memory.allocate(16);
+    void* large = memory.allocate(3000);
+    [[maybe_unused]] void* guard2 = memory.allocate(16);
+
+    memory.deallocate(small, 1000);
+    memory.deallocate(large, 3000);
+
+    EXPECT_EQ(memory.allocate(900), small);
+    EXPECT_EQ(memory.allocate(900), large);
+}
+
+// Набор тестов для BuddyMemoryResource
+// Тест: блок делится пополам до нужного порядка и сливается обратно
+TEST(BuddyMemoryResourceTest, SplitAndMerge) {
+    BuddyMemoryResource memory(64 * 1024);
+    size_t largest = memory.get_largest_free_block();
+    size_t free_bytes = memory.get_free_bytes();
+
+    void* a = memory.allocate(16);
+    void* b = memory.allocate(16);
+    EXPECT_EQ(memory.get_allocated_bytes(), 32);
+
+    // Двойники лежат рядом
+    EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 16);
+
+    memory.deallocate(a, 16);
+    memory.deallocate(b, 16);
+    EXPECT_EQ(memory.get_largest_free_block(), largest);
+    EXPECT_EQ(memory.get_free_bytes(), free_bytes);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: блоки-степени двойки выровнены на свой размер
+TEST(BuddyMemoryResourceTest, PowerOfTwoBlocks) {
+    BuddyMemoryResource memory(64 * 1024);
+    void* node = memory.allocate(16);
+    void* buffer = memory.allocate(1024);
+    void* aligned = memory.allocate(100, 256);
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % 1024, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 256, 0u);
+
+    // 100 байт занимают блок 256 байт
+    EXPECT_EQ(memory.get_internal_fragmentation(), 156);
+
+    memory.deallocate(aligned, 100, 256);
+    memory.deallocate(buffer, 1024);
+    memory.deallocate(node, 16);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 0);
+}
+
+// Тест: исчерпание пула
+TEST(BuddyMemoryResourceTest, OutOfMemory) {
+    BuddyMemoryResource memory(4096);
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory.allocate(5000);
+    }, std::bad_alloc);
+}
+
+// Тест: очередь поверх buddy-аллокатора
+TEST(BuddyMemoryResourceTest, QueueOnBuddy) {
+    BuddyMemoryResource memory(64 * 1024);
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(queue.front(), 0);
+        EXPECT_EQ(queue.back(), 99);
+        EXPECT_EQ(memory.get_allocated_count(), 100);
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: повторное освобождение обнаруживается по карте выделенных блоков
+TEST(BuddyMemoryResourceTest, DoubleDeallocation) {
+    BuddyMemoryResource memory(4096);
+    void* a = memory.allocate(64);
+    void* b = memory.allocate(64);
+    memory.deallocate(a, 64);
+    EXPECT_THROW(memory.deallocate(a, 64), std::invalid_argument);
+
+    int dummy;
+    EXPECT_THROW(memory.deallocate(&dummy, 64), std::invalid_argument);
+    memory.deallocate(b, 64);
+}
+
+// Тест: повторное освобождение после слияния с двойником (бит самого блока уже сброшен)
+TEST(BuddyMemoryResourceTest, DoubleDeallocationAfterBuddyMerge) {
+    BuddyMemoryResource memory(4096);
+    void* a = memory.allocate(64);
+    void* b = memory.allocate(64);
+    ASSERT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 64);
+    memory.deallocate(a, 64);
+    memory.deallocate(b, 64);
+    size_t free_bytes = memory.get_free_bytes();
+
+    EXPECT_THROW(memory.deallocate(a, 64), std::invalid_argument);
+    EXPECT_THROW(memory.deallocate(b, 64), std::invalid_argument);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_free_bytes(), free_bytes);
+}
+
+// Тест: указатель внутрь занятого блока и освобождение с чужим размером отклоняются
+TEST(BuddyMemoryResourceTest, InteriorPointer) {
+    BuddyMemoryResource memory(4096);
+    auto* block = static_cast<char*>(memory.allocate(64));
+    EXPECT_THROW(memory.deallocate(block + 16, 16), std::invalid_argument);
+    EXPECT_THROW(memory.deallocate(block + 32, 32), std::invalid_argument);
+    EXPECT_THROW(memory.deallocate(block, 16), std::invalid_argument);
+    EXPECT_EQ(memory.get_allocated_count(), 1);
+    memory.deallocate(block, 64);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+#endif
+
+// Набор тестов для пула узлов очереди (SlabMemoryResource)
+// Тест: слот подобран под узел очереди
+TEST(QueueNodePoolTest, SlotMatchesNode) {
+    EXPECT_GE(QueueNodePool<int>::kSlotSize, Queue<int>::node_size);
+    EXPECT_EQ(QueueNodePool<int>::kSlotSize % Queue<int>::node_alignment, 0u);
+    EXPECT_LT(QueueNodePool<int>::kSlotSize, Queue<int>::node_size + Queue<int>::node_alignment);
+}
+
+// Тест: освобождённый слот выдаётся следующим (LIFO), новая память не нарезается
+TEST(QueueNodePoolTest, SlotReuse) {
+    QueueNodePool<int> memory(64 * 1024);
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+    }
+    EXPECT_EQ(memory.get_carved_count(), 10);
+
+    for (int i = 0; i < 1000; ++i) {
+        queue.push(i);
+        queue.pop();
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 10);
+    EXPECT_EQ(memory.get_carved_count(), 11);
+}
+
+// Тест: один пул на несколько очередей
+TEST(QueueNodePoolTest, SharedBetweenQueues) {
+    QueueNodePool<std::string> memory(64 * 1024);
+    {
+        Queue<std::string> first(&memory);
+        Queue<std::string> second(&memory);
+        for (int i = 0; i < 50; ++i) {
+            first.push("first " + std::to_string(i));
+            second.push("second " + std::to_string(i));
+        }
+        EXPECT_EQ(memory.get_allocated_count(), 100);
+
+        Queue<std::string> copy(first);
+        EXPECT_EQ(memory.get_allocated_count(), 150);
+        EXPECT_EQ(copy.back(), "first 49");
+        EXPECT_EQ(second.front(), "second 0");
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: исчерпание пула и запросы, не помещающиеся в слот
+TEST(QueueNodePoolTest, OutOfSlots) {
+    QueueNodePool<int> memory(4 * QueueNodePool<int>::kSlotSize);
+    EXPECT_EQ(memory.get_capacity(), 4);
+
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 4; ++i) {
+        queue.push(i);
+    }
+    EXPECT_THROW(queue.push(4), std::bad_alloc);
+    EXPECT_EQ(queue.size(), 4);
+
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory.allocate(QueueNodePool<int>::kSlotSize + 1);
+    }, std::bad_alloc);
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: указатель не на начало слота отвергается
+TEST(QueueNodePoolTest, ForeignPointerDeallocation) {
+    QueueNodePool<int> memory(4096);
+    char* slot = static_cast<char*>(memory.allocate(Queue<int>::node_size, Queue<int>::node_alignment));
+    EXPECT_THROW(memory.deallocate(slot + 1, 1), std::invalid_argument);
+
+    int dummy;
+    EXPECT_THROW(memory.deallocate(&dummy, sizeof(dummy)), std::invalid_argument);
+    memory.deallocate(slot, Queue<int>::node_size, Queue<int>::node_alignment);
+}
+#endif
+
+// Набор тестов для ConcurrentFixedMemoryResource
+// Тест: магазин пополняется и сбрасывается пачками
+TEST(ConcurrentFixedMemoryResourceTest, BatchedRefillAndFlush) {
+    ConcurrentFixedMemoryResource memory(64 * 1024);
+    void* ptr = memory.allocate(16);
+    EXPECT_EQ(memory.get_allocated_count(), ConcurrentFixedMemoryResource::kBatchSize);
+    EXPECT_EQ(memory.get_cached_count(), ConcurrentFixedMemoryResource::kBatchSize - 1);
+
+    memory.deallocate(ptr, 16);
+    EXPECT_EQ(memory.get_cached_count(), ConcurrentFixedMemoryResource::kBatchSize);
+
+    // Полный магазин при освобождении отдаёт половину блоков в центральный пул
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < ConcurrentFixedMemoryResource::kMagazineSize + 1; ++i) {
+        blocks.push_back(memory.allocate(16));
+    }
+    for (void* block : blocks) {
+        memory.deallocate(block, 16);
+    }
+    EXPECT_LE(memory.get_cached_count(), ConcurrentFixedMemoryResource::kMagazineSize);
+
+    memory.flush_thread_cache();
+    EXPECT_EQ(memory.get_cached_count(), 0);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: большие блоки идут мимо кэша
+TEST(ConcurrentFixedMemoryResourceTest, LargeBlocksBypassCache) {
+    ConcurrentFixedMemoryResource memory(64 * 1024);
+    void* ptr = memory.allocate(1024);
+    EXPECT_EQ(memory.get_allocated_count(), 1);
+    EXPECT_EQ(memory.get_cached_count(), 0);
+    memory.deallocate(ptr, 1024);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: очереди в разных потоках на одном пуле
+TEST(ConcurrentFixedMemoryResourceTest, QueuesOnWorkerThreads) {
+    ConcurrentFixedMemoryResource memory(1024 * 1024);
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(4, 0);
+
+    for (size_t t = 0; t < sums.size(); ++t) {
+        threads.emplace_back([&memory, &sums, t] {
+            Queue<int> queue(&memory);
+            for (int i = 0; i < 100; ++i) {
+                queue.push(i);
+            }
+            for (int i = 0; i < 20000; ++i) {
+                sums[t] += queue.front();
+                queue.pop();
+                queue.push(i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Очереди и кэши потоков вернули все блоки при завершении потоков
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    for (long long sum : sums) {
+        EXPECT_EQ(sum, sums[0]);
+    }
+}
+
+// Тест: блок, выделенный в одном потоке, освобождается в другом
+TEST(ConcurrentFixedMemoryResourceTest, CrossThreadDeallocation) {
+    ConcurrentFixedMemoryResource memory(64 * 1024);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; ++i) {
+        blocks.push_back(memory.allocate(48));
+    }
+
+    std::thread worker([&memory, &blocks] {
+        for (void* block : blocks) {
+            memory.deallocate(block, 48);
+        }
+    });
+    worker.join();
+
+    memory.flush_thread_cache();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: кэш уничтоженного ресурса не мешает новому
+TEST(ConcurrentFixedMemoryResourceTest, ResourceRecreation) {
+    for (int round = 0; round < 3; ++round) {
+        ConcurrentFixedMemoryResource memory(64 * 1024);
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 10; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(queue.back(), 9);
+    }
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: чужой указатель отвергается и на пути через кэш
+TEST(ConcurrentFixedMemoryResourceTest, ForeignPointerDeallocation) {
+    ConcurrentFixedMemoryResource memory(4096);
+    int dummy;
+    EXPECT_THROW(memory.deallocate(&dummy, sizeof(dummy)), std::invalid_argument);
+}
+
+// Тест: повторное освобождение блока, лежащего в магазине, отвергается
+TEST(ConcurrentFixedMemoryResourceTest, DoubleDeallocation) {
+    ConcurrentFixedMemoryResource memory(64 * 1024);
+    void* ptr = memory.allocate(32);
+    memory.deallocate(ptr, 32);
+    EXPECT_THROW(memory.deallocate(ptr, 32), std::invalid_argument);
+
+    // Блок выдаётся повторно ровно один раз
+    void* a = memory.allocate(32);
+    void* b = memory.allocate(32);
+    EXPECT_NE(a, b);
+    memory.deallocate(a, 32);
+    memory.deallocate(b, 32);
+    memory.flush_thread_cache();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+#endif
+
+// Набор тестов для растущего пула FixedMemoryResource
+// Upstream, который считает выданные участки
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t live_bytes = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        live_bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        live_bytes -= bytes;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Тест: вместо bad_alloc подключаются участки геометрически растущего размера
+TEST(GrowablePoolTest, GrowsGeometrically) {
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    GTEST_SKIP() << "Exact block sizes differ with guard bytes";
+#endif
+    CountingResource upstream;
+    {
+        FixedMemoryResourceOptions options;
+        options.initial_size = 4096;
+        options.upstream = &upstream;
+        FixedMemoryResource memory(options);
+
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 800; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(queue.size(), 800);
+        EXPECT_EQ(queue.back(), 799);
+
+        // 800 блоков по 32 байта помещаются в участки 4, 8 и 16 КБ
+        EXPECT_EQ(memory.get_chunk_count(), 3);
+        EXPECT_EQ(memory.get_total_size(), 4096 + 8192 + 16384);
+        EXPECT_EQ(upstream.allocations, 3);
+        EXPECT_EQ(upstream.live_bytes, memory.get_total_size());
+    }
+    // Все участки возвращены upstream
+    EXPECT_EQ(upstream.live_bytes, 0);
+}
+
+// Тест: участок подключается с запасом под крупный запрос
+TEST(GrowablePoolTest, LargeRequestGetsBigEnoughChunk) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 1024;
+    options.upstream = std::pmr::new_delete_resource();
+    FixedMemoryResource memory(options);
+
+    void* small = memory.allocate(100);
+    void* large = memory.allocate(64 * 1024, 256);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 256, 0u);
+    EXPECT_EQ(memory.get_chunk_count(), 2);
+
+    memory.deallocate(large, 64 * 1024, 256);
+    memory.deallocate(small, 100);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: предел суммарного размера
+TEST(GrowablePoolTest, HardCap) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 4096;
+    options.upstream = std::pmr::new_delete_resource();
+    options.max_total_size = 10000;
+    FixedMemoryResource memory(options);
+
+    std::vector<void*> blocks;
+    EXPECT_THROW({
+        for (;;) {
+            blocks.push_back(memory.allocate(64));
+        }
+    }, std::bad_alloc);
+    EXPECT_LE(memory.get_total_size(), options.max_total_size);
+    EXPECT_GT(memory.get_total_size(), 4096);
+
+    for (void* block : blocks) {
+        memory.deallocate(block, 64);
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: блоки закрытого участка сливаются и переиспользуются, не выходя за его границы
+TEST(GrowablePoolTest, ClosedChunkReuse) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 1024;
+    options.upstream = std::pmr::new_delete_resource();
+    FixedMemoryResource memory(options);
+
+    std::vector<void*> first_chunk;
+    while (memory.get_chunk_count() == 1) {
+        first_chunk.push_back(memory.allocate(48));
+    }
+    // Последний блок уже лежит во втором участке
+    void* second = first_chunk.back();
+    first_chunk.pop_back();
+
+    for (void* block : first_chunk) {
+        memory.deallocate(block, 48);
+    }
+    // Первый участок целиком слился в один свободный блок
+    EXPECT_EQ(memory.get_free_count(), 1);
+
+    size_t offset = memory.get_current_offset();
+    void* reused = memory.allocate(512);
+    EXPECT_EQ(reused, first_chunk.front());
+    EXPECT_EQ(memory.get_current_offset(), offset);
+
+    memory.deallocate(reused, 512);
+    memory.deallocate(second, 48);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: без upstream пул остаётся фиксированным
+TEST(GrowablePoolTest, FixedWithoutUpstream) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 256;
+    FixedMemoryResource memory(options);
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory.allocate(512);
+    }, std::bad_alloc);
+    EXPECT_EQ(memory.get_chunk_count(), 1);
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: проверки освобождения работают во всех участках
+TEST(GrowablePoolTest, CheckedDeallocationAcrossChunks) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 256;
+    options.upstream = std::pmr::new_delete_resource();
+    FixedMemoryResource memory(options);
+
+    std::vector<void*> blocks;
+    while (memory.get_chunk_count() < 3) {
+        blocks.push_back(memory.allocate(32));
+    }
+
+    memory.deallocate(blocks[1], 32);
+    EXPECT_THROW(memory.deallocate(blocks[1], 32), std::invalid_argument);
+    EXPECT_THROW(memory.deallocate(static_cast<char*>(blocks[2]) + 16, 16), std::invalid_argument);
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (i != 1) {
+            memory.deallocate(blocks[i], 32);
+        }
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+#endif
+
+// Набор тестов для MappedMemoryResource
+// Пул FixedMemoryResource из mmap без роста
+static FixedMemoryResourceOptions mapped_pool(MappedMemoryResource& mapped, size_t size) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = size;
+    options.upstream = &mapped;
+    options.max_total_size = size;
+    return options;
+}
+
+// Тест: отображения выровнены на страницу и возвращаются при освобождении
+TEST(MappedMemoryResourceTest, PageAlignedMappings) {
+    MappedMemoryResource mapped;
+    void* ptr = mapped.allocate(10000);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % mapped.get_page_size(), 0u);
+    EXPECT_EQ(mapped.get_mapped_bytes() % mapped.get_page_size(), 0u);
+    EXPECT_GE(mapped.get_mapped_bytes(), 10000u);
+
+    static_cast<char*>(ptr)[9999] = 1;
+    mapped.deallocate(ptr, 10000);
+    EXPECT_EQ(mapped.get_mapping_count(), 0);
+    EXPECT_EQ(mapped.get_mapped_bytes(), 0);
+}
+
+// Тест: очередь поверх фиксированного пула из mmap
+TEST(MappedMemoryResourceTest, FixedPoolOnMapping) {
+    MappedMemoryResource mapped({HugePages::None, true, false});
+    {
+        FixedMemoryResource memory(mapped_pool(mapped, 64 * 1024));
+        EXPECT_EQ(mapped.get_mapping_count(), 1);
+
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 1000; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(queue.back(), 999);
+
+        // Предел равен начальному размеру - пул не растёт
+        EXPECT_THROW({
+            [[maybe_unused]] void* ptr = memory.allocate(64 * 1024);
+        }, std::bad_alloc);
+        EXPECT_EQ(memory.get_chunk_count(), 1);
+    }
+    EXPECT_EQ(mapped.get_mapping_count(), 0);
+}
+
+// Тест: большие страницы - при их отсутствии выделение всё равно успешно
+TEST(MappedMemoryResourceTest, HugePagesWithFallback) {
+    for (HugePages mode : {HugePages::Transparent, HugePages::Explicit}) {
+        MappedMemoryResource mapped({mode, false, false});
+        EXPECT_EQ(mapped.get_page_size(), 2u * 1024 * 1024);
+
+        FixedMemoryResource memory(mapped_pool(mapped, 1024 * 1024));
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(queue.size(), 100);
+        EXPECT_LE(mapped.get_huge_page_fallbacks(), 1u);
+    }
+}
+
+#ifdef __linux__
+// Тест: после заполнения все страницы уже в памяти
+TEST(MappedMemoryResourceTest, PopulatedPagesAreResident) {
+    for (HugePages mode : {HugePages::None, HugePages::Transparent}) {
+        MappedMemoryResource mapped({mode, true, true});
+        size_t size = 4 * 1024 * 1024;
+        void* ptr = mapped.allocate(size);
+
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> residency(size / page);
+        ASSERT_EQ(mincore(ptr, size, residency.data()), 0);
+        for (unsigned char resident : residency) {
+            EXPECT_TRUE(resident & 1);
+        }
+
+        // mlock может не удаться из-за RLIMIT_MEMLOCK - это учитывается, но не ошибка
+        EXPECT_LE(mapped.get_lock_failures(), 1u);
+        mapped.deallocate(ptr, size);
+    }
+}
+#endif
+
+// Набор тестов для возврата памяти системе (trim)
+#ifdef __linux__
+// Тест: после всплеска и опустошения очереди RSS пула возвращается к исходному
+TEST(TrimTest, SpikeAndDrain) {
+    FixedMemoryResource memory(32 * 1024 * 1024);
+    size_t idle = memory.get_resident_bytes();
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 500000; ++i) {
+            queue.push(i);
+        }
+        EXPECT_GE(memory.get_resident_bytes(), idle + 15 * 1024 * 1024);
+    }
+
+    size_t reclaimed = memory.trim();
+    EXPECT_GE(reclaimed, 15u * 1024 * 1024);
+    EXPECT_LE(memory.get_resident_bytes(), idle + 64 * 1024);
+
+    // Пул работает как прежде
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 1000; ++i) {
+        queue.push(i);
+    }
+    EXPECT_EQ(queue.back(), 999);
+}
+
+// Тест: страницы большого свободного блока возвращаются, а сам блок остаётся в списке
+TEST(TrimTest, FreeBlockPagesReleased) {
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    GTEST_SKIP() << "trim keeps free blocks resident to preserve the freed-memory pattern";
+#endif
+    FixedMemoryResource memory(4 * 1024 * 1024);
+    size_t size = 1024 * 1024;
+    auto* large = static_cast<char*>(memory.allocate(size));
+    void* guard = memory.allocate(16);
+    std::fill(large, large + size, 'x');
+    memory.deallocate(large, size);
+    EXPECT_EQ(memory.get_free_count(), 1);
+
+    size_t resident = memory.get_resident_bytes();
+    size_t reclaimed = memory.trim();
+    EXPECT_GE(reclaimed, size - 2 * 4096);
+    EXPECT_LE(memory.get_resident_bytes(), resident - reclaimed);
+
+    // Повторный trim ничего не находит
+    EXPECT_EQ(memory.trim(), 0);
+
+    // Блок по-прежнему переиспользуется
+    EXPECT_EQ(memory.get_free_count(), 1);
+    void* again = memory.allocate(size);
+    EXPECT_EQ(again, large);
+    memory.deallocate(again, size);
+    memory.deallocate(guard, 16);
+}
+
+// Тест: фоновая очистка пула, общего для нескольких потоков
+TEST(TrimTest, BackgroundTrim) {
+    ConcurrentFixedMemoryResource memory(32 * 1024 * 1024);
+    size_t idle = memory.get_resident_bytes();
+    memory.start_background_trim(std::chrono::milliseconds(5));
+
+    std::thread worker([&memory] {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 300000; ++i) {
+            queue.push(i);
+        }
+    });
+    worker.join();
+
+    // Ждём, пока фоновый поток отдаст память
+    for (int attempt = 0; attempt < 200 && memory.get_resident_bytes() > idle + 256 * 1024; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_LE(memory.get_resident_bytes(), idle + 256 * 1024);
+    memory.stop_background_trim();
+}
+#endif
+
+// Набор тестов для освобождения пула целиком (release) и Queue::discard
+// Тест: release возвращает пул в исходное состояние
+TEST(ReleaseTest, ResetsPool) {
+    FixedMemoryResource memory(64 * 1024);
+    void* first = memory.allocate(100);
+    std::vector<void*> blocks;
+    for (int i = 0; i < 50; ++i) {
+        blocks.push_back(memory.allocate(16 + i * 8, i % 3 == 0 ? 64 : 16));
+    }
+    memory.deallocate(blocks[10], 16 + 10 * 8, 64);
+    memory.deallocate(blocks[20], 16 + 20 * 8);
+    EXPECT_GT(memory.get_free_count(), 0);
+
+    memory.release();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_free_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+    EXPECT_EQ(memory.get_internal_fragmentation(), 0);
+    EXPECT_EQ(memory.get_free_bytes(), 64 * 1024);
+
+    // Выделение снова начинается с начала пула
+    void* again = memory.allocate(100);
+    EXPECT_EQ(again, first);
+    memory.deallocate(again, 100);
+}
+
+// Тест: дополнительные участки растущего пула возвращаются upstream
+TEST(ReleaseTest, ReturnsGrownChunks) {
+    CountingResource upstream;
+    FixedMemoryResourceOptions options;
+    options.initial_size = 4096;
+    options.upstream = &upstream;
+    FixedMemoryResource memory(options);
+
+    for (int i = 0; i < 1000; ++i) {
+        [[maybe_unused]] void* ptr = memory.allocate(64);
+    }
+    EXPECT_GT(memory.get_chunk_count(), 1);
+
+    memory.release();
+    EXPECT_EQ(memory.get_chunk_count(), 1);
+    EXPECT_EQ(memory.get_total_size(), 4096);
+    EXPECT_EQ(upstream.live_bytes, 4096);
+
+    // Пул снова растёт при необходимости
+    for (int i = 0; i < 100; ++i) {
+        [[maybe_unused]] void* ptr = memory.allocate(64);
+    }
+    EXPECT_EQ(memory.get_chunk_count(), 2);
+    memory.release();
+}
+
+// Тест: discard опустошает очередь, не возвращая узлы в ресурс
+TEST(ReleaseTest, QueueDiscardThenRelease) {
+    FixedMemoryResource memory(64 * 1024);
+    Queue<int> queue(&memory);
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            queue.push(i);
+        }
+        EXPECT_EQ(memory.get_allocated_count(), 1000);
+
+        queue.discard();
+        EXPECT_TRUE(queue.empty());
+        EXPECT_EQ(queue.begin(), queue.end());
+        EXPECT_EQ(memory.get_allocated_count(), 1000);
+
+        memory.release();
+        EXPECT_EQ(memory.get_allocated_count(), 0);
+    }
+}
+
+// Тип, считающий вызовы деструктора
+struct DestructionCounter {
+    static int destroyed;
+    int value;
+
+    DestructionCounter(int v) : value(v) {}
+    DestructionCounter(const DestructionCounter&) = default;
+    ~DestructionCounter() { ++destroyed; }
+};
+
+int DestructionCounter::destroyed = 0;
+
+// Тест: discard вызывает деструкторы нетривиальных элементов
+TEST(ReleaseTest, DiscardDestroysElements) {
+    FixedMemoryResource memory(64 * 1024);
+    Queue<DestructionCounter> queue(&memory);
+    for (int i = 0; i < 10; ++i) {
+        queue.push(DestructionCounter(i));
+    }
+    DestructionCounter::destroyed = 0;
+
+    queue.discard();
+    EXPECT_EQ(DestructionCounter::destroyed, 10);
+    memory.release();
+}
+
+// Тест: узлы очереди, созданные в фазе, освобождаются откатом без обхода
+TEST(MarkerTest, RollbackPhase) {
+    FixedMemoryResource memory(64 * 1024);
+    void* before = memory.allocate(100);
+    size_t offset = memory.get_current_offset();
+
+    for (int round = 0; round < 3; ++round) {
+        auto marker = memory.mark();
+        EXPECT_EQ(marker.get_offset(), offset);
+        EXPECT_EQ(memory.get_marker_depth(), 1);
+
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 500; ++i) {
+            queue.push(i);
+        }
+        queue.discard();
+
+        EXPECT_EQ(memory.rollback(marker), 500);
+        EXPECT_EQ(memory.get_marker_depth(), 0);
+        EXPECT_EQ(memory.get_current_offset(), offset);
+        EXPECT_EQ(memory.get_allocated_count(), 1);
+    }
+    memory.deallocate(before, 100);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: блоки, свободные до метки, не переиспользуются в фазе и доступны после отката
+TEST(MarkerTest, FreeBlocksBeforeMarkerArePreserved) {
+    FixedMemoryResource memory(64 * 1024);
+    void* a = memory.allocate(64);
+    void* b = memory.allocate(64);
+    memory.deallocate(a, 64);
+    size_t free_count = memory.get_free_count();
+
+    auto marker = memory.mark();
+    EXPECT_EQ(memory.get_free_count(), 0);
+    void* phase = memory.allocate(64);
+    EXPECT_NE(phase, a);
+    memory.deallocate(phase, 64);
+
+    EXPECT_EQ(memory.rollback(marker), 0);
+    EXPECT_EQ(memory.get_free_count(), free_count);
+    EXPECT_EQ(memory.allocate(64), a);
+    memory.deallocate(a, 64);
+    memory.deallocate(b, 64);
+}
+
+// Тест: освобождение блока, выделенного до метки, откладывается до отката
+TEST(MarkerTest, DeferredReleaseOfOlderBlocks) {
+    FixedMemoryResource memory(64 * 1024);
+    void* a = memory.allocate(64);
+    void* b = memory.allocate(64);
+    void* c = memory.allocate(64);
+
+    auto marker = memory.mark();
+    void* phase = memory.allocate(64);
+    memory.deallocate(a, 64);
+    memory.deallocate(b, 64);
+    EXPECT_EQ(memory.get_allocated_count(), 2);
+    // Отложенные блоки не выдаются повторно
+    void* other = memory.allocate(64);
+    EXPECT_NE(other, a);
+    EXPECT_NE(other, b);
+
+    EXPECT_EQ(memory.rollback(marker), 2);
+    (void)phase;
+    EXPECT_EQ(memory.get_allocated_count(), 1);
+
+    // После отката a и b слились в один свободный блок
+    EXPECT_EQ(memory.get_free_count(), 1);
+    void* merged = memory.allocate(100);
+    EXPECT_EQ(merged, a);
+    memory.deallocate(merged, 100);
+    memory.deallocate(c, 64);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: вложенные метки откатываются в обратном порядке
+TEST(MarkerTest, NestedMarkers) {
+    FixedMemoryResource memory(64 * 1024);
+    void* a = memory.allocate(64);
+
+    auto outer = memory.mark();
+    void* b = memory.allocate(64);
+    auto inner = memory.mark();
+    EXPECT_EQ(memory.get_marker_depth(), 2);
+    [[maybe_unused]] void* c = memory.allocate(64);
+
+    // Внешнюю метку нельзя откатить раньше внутренней
+    EXPECT_THROW(memory.rollback(outer), std::invalid_argument);
+
+    // a освобождается во внутренней фазе, но принадлежит уровню до внешней метки
+    memory.deallocate(a, 64);
+    memory.deallocate(b, 64);
+    EXPECT_EQ(memory.rollback(inner), 1);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+
+    // b вернулся в пул внешней фазы, a всё ещё ждёт внешнего отката
+    EXPECT_EQ(memory.allocate(64), b);
+    EXPECT_EQ(memory.rollback(outer), 1);
+    EXPECT_EQ(memory.get_marker_depth(), 0);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: участки, подключённые в фазе, возвращаются upstream при откате
+TEST(MarkerTest, RollbackReturnsGrownChunks) {
+    CountingResource upstream;
+    FixedMemoryResourceOptions options;
+    options.initial_size = 4096;
+    options.upstream = &upstream;
+    FixedMemoryResource memory(options);
+    [[maybe_unused]] void* first = memory.allocate(64);
+
+    auto marker = memory.mark();
+    for (int i = 0; i < 500; ++i) {
+        [[maybe_unused]] void* ptr = memory.allocate(64);
+    }
+    EXPECT_GT(memory.get_chunk_count(), 1);
+
+    EXPECT_EQ(memory.rollback(marker), 500);
+    EXPECT_EQ(memory.get_chunk_count(), 1);
+    EXPECT_EQ(upstream.live_bytes, 4096);
+    EXPECT_EQ(memory.get_allocated_count(), 1);
+    memory.deallocate(first, 64);
+}
+
+#if FIXED_MEMORY_RESOURCE_CHECKED
+// Тест: откатанный блок нельзя освободить
+TEST(MarkerTest, RolledBackPointerDeallocation) {
+    FixedMemoryResource memory(64 * 1024);
+    auto marker = memory.mark();
+    void* ptr = memory.allocate(64);
+    memory.rollback(marker);
+    EXPECT_THROW(memory.deallocate(ptr, 64), std::invalid_argument);
+}
+#endif
+
+// Тест: откат с ожидаемым числом занятых блоков замечает забытые блоки фазы
+TEST(MarkerTest, RollbackExpectedLive) {
+    FixedMemoryResource memory(64 * 1024);
+    auto marker = memory.mark();
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+    }
+    queue.discard();
+    EXPECT_EQ(memory.rollback(marker, 10), 10);
+
+    marker = memory.mark();
+    [[maybe_unused]] void* forgotten = memory.allocate(64);
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    EXPECT_THROW(memory.rollback(marker, 0), std::logic_error);
+#else
+    EXPECT_EQ(memory.rollback(marker, 0), 1);
+#endif
+    // Откат выполнен и при ошибке
+    EXPECT_EQ(memory.get_marker_depth(), 0);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: счётчики выделений, путей выделения и занятой памяти
+TEST(StatsTest, CountersTrackAllocations) {
+#if FIXED_MEMORY_RESOURCE_HARDENED
+    GTEST_SKIP() << "Exact block sizes differ with guard bytes";
+#endif
+    FixedMemoryResource memory(64 * 1024);
+    void* a = memory.allocate(100);
+    void* b = memory.allocate(10);
+    memory.deallocate(a, 100);
+    void* c = memory.allocate(100);
+
+    FixedMemoryStats stats = memory.stats();
+    EXPECT_EQ(stats.allocations, 3);
+    EXPECT_EQ(stats.deallocations, 1);
+    EXPECT_EQ(stats.bump_allocations, 2);
+    EXPECT_EQ(stats.free_list_hits, 1);
+    EXPECT_EQ(stats.failed_allocations, 0);
+    // Блоки вместе с заголовками: 16 + 100 -> 128, 16 + 10 -> 32
+    EXPECT_EQ(stats.bytes_in_use, 128 + 32);
+    EXPECT_EQ(stats.peak_bytes_in_use, 128 + 32);
+    EXPECT_EQ(stats.internal_fragmentation, memory.get_internal_fragmentation());
+
+    memory.deallocate(b, 10);
+    memory.deallocate(c, 100);
+    stats = memory.stats();
+    EXPECT_EQ(stats.bytes_in_use, 0);
+    EXPECT_EQ(stats.peak_bytes_in_use, 128 + 32);
+    EXPECT_EQ(stats.deallocations, 3);
+}
+
+// Тест: гистограмма размеров запросов по степеням двойки
+TEST(StatsTest, SizeHistogram) {
+    FixedMemoryResource memory(1024 * 1024);
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t bytes : {1, 16, 17, 32, 1000, 300000}) {
+        blocks.push_back({memory.allocate(bytes), bytes});
+    }
+
+    FixedMemoryStats stats = memory.stats();
+    EXPECT_EQ(stats.size_histogram[0], 2);  // до 16 байт
+    EXPECT_EQ(stats.size_histogram[1], 2);  // до 32 байт
+    EXPECT_EQ(stats.size_histogram[6], 1);  // до 1024 байт
+    EXPECT_EQ(stats.size_histogram[FixedMemoryStats::kHistogramBuckets - 1], 1);
+    for (auto& [ptr, bytes] : blocks) {
+        memory.deallocate(ptr, bytes);
+    }
+}
+
+// Тест: неудачные выделения и внешняя фрагментация
+TEST(StatsTest, FailuresAndFragmentation) {
+    FixedMemoryResource memory(4096);
+    EXPECT_EQ(memory.stats().external_fragmentation, 0.0);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 8; ++i) {
+        blocks.push_back(memory.allocate(240));
+    }
+    for (int i = 0; i < 8; i += 2) {
+        memory.deallocate(blocks[i], 240);
+    }
+    EXPECT_GT(memory.stats().external_fragmentation, 0.0);
+
+    EXPECT_THROW({
+        [[maybe_unused]] void* ptr = memory.allocate(8192);
+    }, std::bad_alloc);
+    EXPECT_EQ(memory.stats().failed_allocations, 1);
+
+    for (int i = 1; i < 8; i += 2) {
+        memory.deallocate(blocks[i], 240);
+    }
+    EXPECT_EQ(memory.stats().external_fragmentation, 0.0);
+}
+
+// Тест: откат и сброс пула согласованы со счётчиками
+TEST(StatsTest, RollbackAndRelease) {
+    FixedMemoryResource memory(64 * 1024);
+    void* a = memory.allocate(48);
+    size_t before = memory.stats().bytes_in_use;
+
+    auto marker = memory.mark();
+    for (int i = 0; i < 10; ++i) {
+        [[maybe_unused]] void* ptr = memory.allocate(48);
+    }
+    memory.deallocate(a, 48);
+    memory.rollback(marker);
+    EXPECT_EQ(memory.stats().bytes_in_use, 0);
+    EXPECT_EQ(memory.stats().peak_bytes_in_use, 11 * before);
+
+    [[maybe_unused]] void* b = memory.allocate(48);
+    memory.release();
+    EXPECT_EQ(memory.stats().bytes_in_use, 0);
+    EXPECT_EQ(memory.stats().allocations, 12);
+}
+
+// Тест: снимок читается из другого потока без блокировок
+TEST(StatsTest, ConcurrentSnapshot) {
+    ConcurrentFixedMemoryResource memory(1024 * 1024);
+    std::atomic<bool> done{false};
+    size_t observed = 0;
+    std::thread reader([&] {
+        while (!done.load()) {
+            observed = std::max(observed, memory.stats().bytes_in_use);
+        }
+    });
+
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 10000; ++i) {
+            queue.push(i);
+        }
+        EXPECT_GT(memory.stats().bytes_in_use, 0);
+    }
+    done = true;
+    reader.join();
+    memory.flush_thread_cache();
+
+    FixedMemoryStats stats = memory.stats();
+    EXPECT_EQ(stats.bytes_in_use, 0);
+    EXPECT_EQ(stats.allocations, stats.deallocations);
+    EXPECT_LE(observed, stats.peak_bytes_in_use);
+}
+
+// Тест: лог-линейные корзины покрывают значения без пропусков с погрешностью не больше 1/16
+TEST(LatencyHistogramTest, BucketBounds) {
+    for (uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull,
+                           ~0ull}) {
+        size_t bucket = LatencyHistogram::bucket_of(value);
+        EXPECT_LT(bucket, LatencyHistogram::kBucketCount);
+        EXPECT_LE(LatencyHistogram::bucket_lower(bucket), value);
+        EXPECT_GE(LatencyHistogram::bucket_upper(bucket), value);
+        uint64_t width = LatencyHistogram::bucket_upper(bucket) - LatencyHistogram::bucket_lower(bucket);
+        EXPECT_LE(width, LatencyHistogram::bucket_lower(bucket) / LatencyHistogram::kSubBucketCount);
+    }
+    for (size_t bucket = 1; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+        EXPECT_EQ(LatencyHistogram::bucket_lower(bucket), LatencyHistogram::bucket_upper(bucket - 1) + 1);
+    }
+}
+
+// Тест: перцентили, среднее и сброс
+TEST(LatencyHistogramTest, PercentilesAndReset) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.get_count(), 1000);
+    EXPECT_EQ(histogram.get_min(), 1);
+    EXPECT_EQ(histogram.get_max(), 1000);
+    EXPECT_DOUBLE_EQ(histogram.get_mean(), 500.5);
+    EXPECT_NEAR(static_cast<double>(histogram.get_percentile(50.0)), 500.0, 500.0 / 16);
+    EXPECT_NEAR(static_cast<double>(histogram.get_percentile(99.0)), 990.0, 990.0 / 16);
+    EXPECT_EQ(histogram.get_percentile(100.0), 1000);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.get_count(), 0);
+    EXPECT_EQ(histogram.get_percentile(50.0), 0);
+    EXPECT_EQ(histogram.get_max(), 0);
+}
+
+#if FIXED_MEMORY_RESOURCE_LATENCY
+// Тест: каждый вызов allocate/deallocate попадает в гистограмму
+TEST(LatencyHistogramTest, ResourceInstrumentation) {
+    FixedMemoryResource memory(64 * 1024);
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+    }
+    EXPECT_EQ(memory.get_allocate_latency().get_count(), 100);
+    EXPECT_EQ(memory.get_deallocate_latency().get_count(), 100);
+    EXPECT_GT(memory.get_allocate_latency().get_max(), 0);
+    memory.print_latency();
+
+    memory.reset_latency();
+    EXPECT_EQ(memory.get_allocate_latency().get_count(), 0);
+}
+#endif
+
+// Тест: allocate, deallocate и release ресурса попадают в трассу
+TEST(TraceTest, RecordsResourceOperations) {
+    TraceRecorder recorder(1024);
+    FixedMemoryResource memory(64 * 1024);
+    memory.set_trace_recorder(&recorder);
+
+    void* a = memory.allocate(100, 64);
+    void* b = memory.allocate(24);
+    memory.deallocate(a, 100, 64);
+    memory.release();
+    memory.set_trace_recorder(nullptr);
+    [[maybe_unused]] void* untraced = memory.allocate(8);
+
+    std::vector<TraceEvent> events = recorder.get_events();
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events[0].op, TraceOp::Allocate);
+    EXPECT_EQ(events[0].size, 100);
+    EXPECT_EQ(events[0].alignment_log2, 6);
+    EXPECT_EQ(events[0].address, reinterpret_cast<uintptr_t>(a));
+    EXPECT_EQ(events[1].address, reinterpret_cast<uintptr_t>(b));
+    EXPECT_EQ(events[2].op, TraceOp::Deallocate);
+    EXPECT_EQ(events[2].address, events[0].address);
+    EXPECT_EQ(events[3].op, TraceOp::Release);
+    EXPECT_LE(events[0].timestamp, events[3].timestamp);
+}
+
+// Тест: без файла кольцевой буфер хранит последние события
+TEST(TraceTest, RingKeepsLatestEvents) {
+    TraceRecorder recorder(5);
+    for (size_t i = 0; i < 20; ++i) {
+        recorder.record(TraceOp::Allocate, i, 8, nullptr);
+    }
+    std::vector<TraceEvent> events = recorder.get_events();
+    ASSERT_EQ(events.size(), 8);
+    EXPECT_EQ(events.front().size, 12);
+    EXPECT_EQ(events.back().size, 19);
+    EXPECT_EQ(recorder.get_recorded_count(), 20);
+    EXPECT_EQ(recorder.get_dropped_count(), 12);
+}
+
+// Тест: с открытым файлом события пишутся без потерь и читаются обратно
+TEST(TraceTest, FileRoundTrip) {
+    std::string path = ::testing::TempDir() + "lab05_trace_test.bin";
+    {
+        TraceRecorder recorder(16);
+        recorder.open(path);
+        FixedMemoryResource memory(64 * 1024);
+        memory.set_trace_recorder(&recorder);
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+        queue.clear();
+        EXPECT_EQ(recorder.get_dropped_count(), 0);
+    }
+
+    std::vector<TraceEvent> events = TraceRecorder::load(path);
+    ASSERT_EQ(events.size(), 200);
+    EXPECT_EQ(std::count_if(events.begin(), events.end(),
+                            [](const TraceEvent& event) { return event.op == TraceOp::Allocate; }),
+              100);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(TraceRecorder::load(path), std::runtime_error);
+}
+
+// Тест: испорченные события в файле отклоняются при загрузке, а не при воспроизведении
+TEST(TraceTest, CorruptedFileRejected) {
+    std::string path = ::testing::TempDir() + "lab05_trace_corrupted.bin";
+    std::vector<TraceEvent> events(2, TraceEvent{1, 0x1000, 64, TraceOp::Allocate, 4, 0});
+    events[1].op = TraceOp::Deallocate;
+    TraceRecorder::save(path, events);
+    EXPECT_EQ(TraceRecorder::load(path).size(), 2);
+
+    events[1].alignment_log2 = 40;
+    TraceRecorder::save(path, events);
+    EXPECT_THROW(TraceRecorder::load(path), std::runtime_error);
+    EXPECT_THROW(TraceReplay replay(events), std::invalid_argument);
+
+    events[1].alignment_log2 = 4;
+    std::memset(&events[1].op, 7, sizeof(events[1].op));
+    TraceRecorder::save(path, events);
+    EXPECT_THROW(TraceRecorder::load(path), std::runtime_error);
+    EXPECT_THROW(TraceReplay replay(events), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+// Тест: трасса воспроизводится на другом ресурсе
+TEST(TraceTest, ReplayOnAnyResource) {
+    TraceRecorder recorder;
+    FixedMemoryResource memory(64 * 1024);
+    memory.set_trace_recorder(&recorder);
+    {
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+            if (i % 2 == 0) {
+                queue.pop();
+            }
+        }
+    }
+    [[maybe_unused]] void* leaked = memory.allocate(64);
+
+    TraceReplay replay(recorder.get_events());
+    EXPECT_EQ(replay.get_operation_count(), 201);
+    EXPECT_EQ(replay.get_slot_count(), 50);
+
+    std::pmr::unsynchronized_pool_resource pool;
+    TraceReplayResult result = replay.run(pool);
+    EXPECT_EQ(result.operations, 201);
+    EXPECT_EQ(result.failures, 0);
+    EXPECT_EQ(result.peak_live_bytes, 50 * Queue<int>::node_size);
+
+    // Блоки из трассы освобождаются, даже если в трассе их освобождения нет
+    FixedMemoryResource target(64 * 1024);
+    replay.run(target);
+    EXPECT_EQ(target.get_allocated_count(), 0);
+}
+
+// Тест: откат к метке попадает в трассу и при воспроизведении освобождает блоки фазы
+TEST(TraceTest, ReplayRollback) {
+    TraceRecorder recorder(1 << 15);
+    FixedMemoryResource memory(64 * 1024);
+    memory.set_trace_recorder(&recorder);
+    [[maybe_unused]] void* kept = memory.allocate(32);
+    for (int round = 0; round < 100; ++round) {
+        FixedMemoryResource::Marker marker = memory.mark();
+        for (int i = 0; i < 100; ++i) {
+            [[maybe_unused]] void* ptr = memory.allocate(64);
+        }
+        EXPECT_EQ(memory.rollback(marker), 100);
+    }
+
+    std::vector<TraceEvent> events = recorder.get_events();
+    EXPECT_EQ(events.back().op, TraceOp::Rollback);
+    EXPECT_EQ(events.back().marker_depth, 0);
+    EXPECT_EQ(events[1].marker_depth, 1);
+
+    TraceReplay replay(events);
+    EXPECT_EQ(replay.get_slot_count(), 101);
+    EXPECT_EQ(replay.get_operation_count(), 1 + 100 * 200);
+    FixedMemoryResource target(64 * 1024);
+    TraceReplayResult result = replay.run(target);
+    EXPECT_EQ(result.peak_live_bytes, 32 + 100 * 64);
+    EXPECT_EQ(result.failures, 0);
+
+    result = replay.run(*std::pmr::new_delete_resource());
+    EXPECT_EQ(result.peak_live_bytes, 32 + 100 * 64);
+}
+
+// Тест: повторное выделение ещё занятого адреса освобождает прежний блок
+TEST(TraceTest, ReplayReusedAddress) {
+    std::vector<TraceEvent> events(2, TraceEvent{1, 0x1000, 64, TraceOp::Allocate, 4, 0});
+    TraceReplay replay(events);
+    EXPECT_EQ(replay.get_slot_count(), 1);
+    EXPECT_EQ(replay.get_operation_count(), 3);
+
+    FixedMemoryResource target(4096);
+    TraceReplayResult result = replay.run(target);
+    EXPECT_EQ(result.peak_live_bytes, 64);
+    EXPECT_EQ(target.get_allocated_count(), 0);
+}
+
+// Тест: счётчики очереди следят за глубиной и числом операций
+TEST(MetricsTest, QueueCounters) {
+    FixedMemoryResource memory(64 * 1024);
+    QueueMetrics metrics;
+    Queue<int> queue(&memory);
+    queue.push(1);
+    queue.set_metrics(&metrics);
+    EXPECT_EQ(metrics.depth, 1);
+
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+    }
+    queue.pop();
+    EXPECT_EQ(metrics.depth, 10);
+    EXPECT_EQ(metrics.pushes, 10);
+    EXPECT_EQ(metrics.pops, 1);
+
+    // Глубина переезжает вместе с содержимым
+    Queue<int> other(std::move(queue));
+    EXPECT_EQ(metrics.depth, 0);
+    queue = std::move(other);
+    EXPECT_EQ(metrics.depth, 10);
+
+    queue.clear();
+    EXPECT_EQ(metrics.depth, 0);
+    EXPECT_EQ(metrics.pops, 11);
+
+    // discard тоже считается извлечением (первый элемент добавлен до подключения счётчиков)
+    FixedMemoryResource::Marker marker = memory.mark();
+    for (int i = 0; i < 5; ++i) {
+        queue.push(i);
+    }
+    queue.discard();
+    memory.rollback(marker);
+    EXPECT_EQ(metrics.depth, 0);
+    EXPECT_EQ(metrics.pushes, 15);
+    EXPECT_EQ(metrics.pops, 16);
+}
+
+// Тест: текстовый формат Prometheus
+TEST(MetricsTest, PrometheusText) {
+    FixedMemoryResource memory(64 * 1024);
+    QueueMetrics metrics;
+    Queue<int> queue(&memory);
+    queue.set_metrics(&metrics);
+    for (int i = 0; i < 5; ++i) {
+        queue.push(i);
+    }
+
+    MetricsExporter exporter;
+    exporter.add_pool("main", memory);
+    exporter.add_queue("jobs", metrics);
+    std::string text = exporter.render(MetricsFormat::Prometheus);
+
+    EXPECT_NE(text.find("# TYPE lab05_pool_allocations_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("lab05_pool_allocations_total{pool=\"main\"} 5\n"), std::string::npos);
+    EXPECT_NE(text.find("lab05_pool_bytes_in_use{pool=\"main\"} " +
+                        std::to_string(memory.stats().bytes_in_use) + "\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("lab05_pool_allocations_by_size_total{pool=\"main\",max_bytes=\"16\"} 5\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("lab05_queue_depth{queue=\"jobs\"} 5\n"), std::string::npos);
+    EXPECT_NE(text.find("lab05_queue_pushes_total{queue=\"jobs\"} 5\n"), std::string::npos);
+}
+
+// Тест: JSON с несколькими источниками
+TEST(MetricsTest, Json) {
+    FixedMemoryResource first(64 * 1024);
+    ConcurrentFixedMemoryResource second(64 * 1024);
+    QueueMetrics metrics;
+
+    MetricsExporter exporter;
+    exporter.add_pool("first", first);
+    exporter.add_pool("sec\"ond", second);
+    exporter.add_queue("q", metrics);
+    std::string json = exporter.render(MetricsFormat::Json);
+
+    EXPECT_EQ(json.rfind("{\"pools\":{\"first\":{\"bytes_in_use\":0,", 0), 0);
+    EXPECT_NE(json.find(",\"sec\\\"ond\":{"), std::string::npos);
+    EXPECT_NE(json.find("\"queues\":{\"q\":{\"depth\":0,\"pushes_total\":0,\"pops_total\":0}}}"),
+              std::string::npos);
+}
+
+// Тест: управляющие символы в имени экранируются по правилам каждого формата
+TEST(MetricsTest, ControlCharactersInNames) {
+    FixedMemoryResource memory(64 * 1024);
+    QueueMetrics metrics;
+    MetricsExporter exporter;
+    exporter.add_pool("a\tb\rc", memory);
+    exporter.add_queue(std::string("q\n\x01", 3), metrics);
+
+    std::string json = exporter.render(MetricsFormat::Json);
+    EXPECT_NE(json.find("\"a\\tb\\rc\":{"), std::string::npos);
+    EXPECT_NE(json.find("\"q\\n\\u0001\":{"), std::string::npos);
+    // Управляющий символ остаётся только в завершающем переводе строки документа
+    EXPECT_EQ(std::count_if(json.begin(), json.end(),
+                            [](char c) { return static_cast<unsigned char>(c) < 0x20; }),
+              json.back() == '\n' ? 1 : 0);
+
+    // В метке Prometheus экранируется только перевод строки
+    std::string text = exporter.render(MetricsFormat::Prometheus);
+    EXPECT_NE(text.find("lab05_queue_depth{queue=\"q\\n\x01\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("{pool=\"a\tb\rc\"}"), std::string::npos);
+}
+
+// Тест: фоновый поток переписывает файл целиком
+TEST(MetricsTest, BackgroundFile) {
+    std::string path = ::testing::TempDir() + "lab05_metrics_test.prom";
+    std::remove(path.c_str());
+
+    FixedMemoryResource memory(64 * 1024);
+    MetricsExporter exporter;
+    exporter.add_pool("main", memory);
+    [[maybe_unused]] void* ptr = memory.allocate(64);
+    exporter.start(path, std::chrono::milliseconds(10));
+
+    // Первая запись происходит сразу при запуске
+    std::string content;
+    for (int attempt = 0; attempt < 200 && content.empty(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::ifstream file(path);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    exporter.stop();
+    EXPECT_NE(content.find("lab05_pool_allocations_total{pool=\"main\"} 1\n"), std::string::npos);
+    std::remove(path.c_str());
+    memory.deallocate(ptr, 64);
+}
+
+#if FIXED_MEMORY_RESOURCE_HARDENED && !defined(LAB05_TEST_ASAN)
+// Тест: запись за конец блока обнаруживается при освобождении, блок остаётся занятым
+// (под AddressSanitizer такую запись останавливает он сам)
+TEST(HardeningTest, OverflowDetectedOnDeallocate) {
+    FixedMemoryResource memory(4096);
+    auto* data = static_cast<char*>(memory.allocate(20));
+    char saved = data[20];
+    data[20] = 'x';
+
+    EXPECT_THROW(memory.deallocate(data, 20), std::runtime_error);
+    EXPECT_EQ(memory.get_allocated_count(), 1);
+
+    data[20] = saved;
+    memory.deallocate(data, 20);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: освобождённые данные залиты узором, запись в них обнаруживается при повторном выделении
+TEST(HardeningTest, UseAfterFreeDetectedOnReuse) {
+    FixedMemoryResource memory(4096);
+    auto* data = static_cast<char*>(memory.allocate(64));
+    [[maybe_unused]] void* guard = memory.allocate(16);
+    memory.deallocate(data, 64);
+
+    // Первые 16 байт данных свободного блока заняты узлом списка
+    EXPECT_EQ(static_cast<unsigned char>(data[16]), 0xDD);
+    EXPECT_EQ(static_cast<unsigned char>(data[63]), 0xDD);
+
+    data[40] = 1;
+    EXPECT_THROW({ [[maybe_unused]] void* ptr = memory.allocate(64); }, std::runtime_error);
+    EXPECT_EQ(memory.get_free_count(), 1);
+
+    data[40] = static_cast<char>(0xDD);
+    EXPECT_EQ(memory.allocate(64), data);
+}
+
+// Тест: повторное освобождение не портит пул
+TEST(HardeningTest, DoubleFreeRejected) {
+    FixedMemoryResource memory(4096);
+    void* data = memory.allocate(64);
+    [[maybe_unused]] void* guard = memory.allocate(16);
+    memory.deallocate(data, 64);
+
+    EXPECT_THROW(memory.deallocate(data, 64), std::invalid_argument);
+    EXPECT_EQ(memory.get_free_count(), 1);
+    EXPECT_EQ(memory.allocate(64), data);
+}
+#endif
+
+#ifdef LAB05_TEST_ASAN
+// Тест: свободная память пула и хвосты занятых блоков недоступны для AddressSanitizer
+TEST(HardeningTest, AsanPoisonsFreeMemory) {
+    FixedMemoryResource memory(4096);
+    auto* data = static_cast<char*>(memory.allocate(20));
+    [[maybe_unused]] void* guard = memory.allocate(16);
+
+    EXPECT_FALSE(__asan_address_is_poisoned(data + 19));
+    EXPECT_TRUE(__asan_address_is_poisoned(data + 20));
+    EXPECT_TRUE(__asan_address_is_poisoned(static_cast<char*>(guard) + 1024));
+
+    memory.deallocate(data, 20);
+    EXPECT_FALSE(__asan_address_is_poisoned(data));
+    EXPECT_TRUE(__asan_address_is_poisoned(data + 16));
+
+    auto* again = static_cast<char*>(memory.allocate(20));
+    EXPECT_EQ(again, data);
+    EXPECT_FALSE(__asan_address_is_poisoned(again + 16));
+}
+#endif
+
+// Тест: очередь со статическим аллокатором берёт узлы из пула без memory_resource
+TEST(StaticPoolTest, QueueUsesPoolDirectly) {
+    using Pool = QueueStaticPool<int, NullLock, CountingPoolStats>;
+    Pool pool(4096);
+    {
+        StaticPoolQueue<int, Pool> queue(&pool);
+        for (int i = 0; i < 10; ++i) {
+            queue.push(i);
+        }
+        queue.pop();
+        queue.pop();
+        queue.pop();
+
+        EXPECT_EQ(queue.front(), 3);
+        EXPECT_EQ(queue.back(), 9);
+        EXPECT_EQ(pool.stats().allocations, 10);
+        EXPECT_EQ(pool.stats().deallocations, 3);
+        EXPECT_EQ(pool.stats().bytes_in_use, 7 * Queue<int>::node_size);
+        EXPECT_EQ(pool.strategy().resource().get_allocated_count(), 7);
+
+        // Копия и перемещение используют тот же пул
+        StaticPoolQueue<int, Pool> copy = queue;
+        StaticPoolQueue<int, Pool> moved = std::move(copy);
+        EXPECT_EQ(moved.size(), 7);
+        EXPECT_EQ(pool.strategy().resource().get_allocated_count(), 14);
+    }
+    EXPECT_EQ(pool.stats().bytes_in_use, 0);
+    EXPECT_EQ(pool.stats().peak_bytes_in_use, 14 * Queue<int>::node_size);
+    EXPECT_EQ(pool.strategy().resource().get_allocated_count(), 0);
+}
+
+// Тест: тот же пул доступен обычной очереди через memory_resource
+TEST(StaticPoolTest, TypeErasedPath) {
+    QueueStaticPool<int, NullLock, CountingPoolStats> pool(4096);
+    Queue<int> queue(&pool);
+    queue.push(1);
+    queue.push(2);
+    EXPECT_EQ(pool.stats().allocations, 2);
+    queue.clear();
+    EXPECT_EQ(pool.stats().deallocations, 2);
+
+    std::pmr::memory_resource& resource = pool;
+    EXPECT_TRUE(resource.is_equal(pool));
+}
+
+// Тест: пул блоков произвольного размера с мьютексом разделяют несколько потоков
+TEST(StaticPoolTest, FixedStrategyWithMutex) {
+    using Pool = StaticPool<FixedStrategy, std::mutex, CountingPoolStats>;
+    Pool pool(size_t{256 * 1024});
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool] {
+            StaticPoolQueue<std::string, Pool> queue(&pool);
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(std::string(1 + i % 50, 'x'));
+                if (i % 3 == 0) {
+                    queue.pop();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(pool.stats().allocations, 4000);
+    EXPECT_EQ(pool.stats().deallocations, 4000);
+    EXPECT_EQ(pool.strategy().resource().get_allocated_count(), 0);
+}
+
+// Тест: поверх FixedMemoryResource проверки пула по умолчанию не дублируют проверки ресурса
+TEST(StaticPoolTest, FixedStrategySkipsDuplicateChecks) {
+    static_assert(std::is_same_v<DefaultPoolChecksFor<FixedStrategy>,
+                                 std::conditional_t<FIXED_MEMORY_RESOURCE_CHECKED, NoPoolChecks,
+                                                    DefaultPoolChecks>>);
+    StaticPool<FixedStrategy> pool(size_t{64 * 1024});
+    void* ptr = pool.allocate(20);
+    // Блок без лишних контрольных байт пула (свои ресурс учитывает в block_size_for)
+    EXPECT_EQ(pool.strategy().resource().stats().bytes_in_use, FixedMemoryResource::block_size_for(20));
+#if FIXED_MEMORY_RESOURCE_CHECKED
+    int foreign = 0;
+    EXPECT_THROW(pool.deallocate(&foreign, sizeof(foreign)), std::invalid_argument);
+#endif
+    pool.deallocate(ptr, 20);
+    EXPECT_EQ(pool.strategy().resource().get_allocated_count(), 0);
+}
+
+// Тест: проверки - политика пула, а не режим сборки
+TEST(StaticPoolTest, CheckPolicies) {
+    alignas(16) char foreign[32] = {};
+
+    StaticPool<SlabStrategy<32>, NullLock, NoPoolStats, OwnershipPoolChecks> checked(4096);
+    EXPECT_THROW(checked.deallocate(foreign, sizeof(foreign)), std::invalid_argument);
+
+    StaticPool<SlabStrategy<32>, NullLock, NoPoolStats, HardenedPoolChecks> hardened(4096);
+    auto* data = static_cast<char*>(hardened.allocate(20));
+    data[20] = 'x';
+    EXPECT_THROW(hardened.deallocate(data, 20), std::runtime_error);
+    data[20] = static_cast<char>(0xAB);
+    hardened.deallocate(data, 20);
+    EXPECT_THROW(hardened.deallocate(data, 20), std::invalid_argument);
+    EXPECT_EQ(hardened.strategy().resource().get_allocated_count(), 0);
+
+    // Запрос вместе с контрольными байтами должен помещаться в слот
+    EXPECT_THROW({ [[maybe_unused]] void* ptr = hardened.allocate(30); }, std::bad_alloc);
+}
+
+// Тест: очередь на 64 элемента в пуле внутри объекта работает без обращений к куче
+TEST(InlinePoolTest, QueueRunsWithoutHeap) {
+    size_t calls_before = g_operator_new_calls;
+    size_t popped = 0;
+    {
+        InlineQueuePool<int, 64> memory;
+        Queue<int> queue(&memory);
+        for (int round = 0; round < 10; ++round) {
+            for (int i = 0; i < 64; ++i) {
+                queue.push(i);
+            }
+            while (!queue.empty()) {
+                queue.pop();
+                ++popped;
+            }
+        }
+    }
+    size_t calls_after = g_operator_new_calls;
+
+    EXPECT_EQ(calls_after, calls_before);
+    EXPECT_EQ(popped, 640);
+}
+
+// Тест: пул заполняется до конца, повторное использование то же, что у FixedMemoryResource
+TEST(InlinePoolTest, SameReuseSemantics) {
+    InlineQueuePool<int, 4> memory;
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 4; ++i) {
+        queue.push(i);
+    }
+    EXPECT_THROW(queue.push(4), std::bad_alloc);
+
+    queue.pop();
+    queue.push(4);
+    EXPECT_EQ(memory.get_free_count(), 0);
+    EXPECT_EQ(memory.get_allocated_count(), 4);
+    EXPECT_EQ(memory.get_current_offset(), 4 * FixedMemoryResource::block_size_for(Queue<int>::node_size));
+}
+
+// Тест: внешняя память первого участка не освобождается ресурсом, следующие участки - у upstream
+TEST(InlinePoolTest, ExternalBuffer) {
+    alignas(16) static unsigned char buffer[4096];
+    CountingResource upstream;
+    {
+        FixedMemoryResourceOptions options;
+        options.initial_size = sizeof(buffer);
+        options.buffer = buffer;
+        options.upstream = &upstream;
+        FixedMemoryResource memory(options);
+
+        void* first = memory.allocate(1024);
+        EXPECT_TRUE(first >= buffer && first < buffer + sizeof(buffer));
+        void* second = memory.allocate(4096);
+        EXPECT_EQ(memory.get_chunk_count(), 2);
+        memory.deallocate(second, 4096);
+        memory.deallocate(first, 1024);
+    }
+    EXPECT_EQ(upstream.allocations, 1);
+    EXPECT_EQ(upstream.live_bytes, 0);
+
+    FixedMemoryResourceOptions misaligned;
+    misaligned.initial_size = 1024;
+    misaligned.buffer = buffer + 8;
+    EXPECT_THROW(FixedMemoryResource memory(misaligned), std::invalid_argument);
+}
+
+#ifdef __linux__
+// Уникальное имя сегмента для теста (тесты могут идти параллельно в разных процессах)
+std::string shared_test_name(const char* test) {
+    return std::string("/lab05_") + test + "_" + std::to_string(getpid());
+}
+
+// Тест: два отображения одного сегмента по разным адресам видят одни и те же данные
+TEST(SharedMemoryTest, SegmentSharedBetweenMappings) {
+    std::string name = shared_test_name("segment");
+    SharedMemorySegment created(name, SharedMemoryMode::Create, 4096);
+    SharedMemorySegment opened(name, SharedMemoryMode::Open);
+
+    EXPECT_TRUE(created.is_owner());
+    EXPECT_FALSE(opened.is_owner());
+    EXPECT_EQ(opened.size(), 4096);
+    EXPECT_NE(created.data(), opened.data());
+
+    static_cast<int*>(created.data())[10] = 42;
+    EXPECT_EQ(static_cast<int*>(opened.data())[10], 42);
+
+    EXPECT_THROW(SharedMemorySegment(name, SharedMemoryMode::Create, 4096), std::runtime_error);
+    EXPECT_THROW(SharedMemorySegment(name + "_missing", SharedMemoryMode::Open), std::runtime_error);
+}
+
+// Тест: сегмент как память пула FixedMemoryResource
+TEST(SharedMemoryTest, SegmentBacksFixedPool) {
+    SharedMemorySegment segment(shared_test_name("pool"), SharedMemoryMode::Create, 64 * 1024);
+    FixedMemoryResourceOptions options;
+    options.initial_size = segment.size();
+    options.buffer = segment.data();
+    FixedMemoryResource memory(options);
+
+    char* begin = static_cast<char*>(segment.data());
+    void* ptr = memory.allocate(1000);
+    EXPECT_TRUE(ptr >= begin && ptr < begin + segment.size());
+    memory.deallocate(ptr, 1000);
+}
+
+// Тест: очередь в одном процессе через два подключения, граничные случаи
+TEST(SharedMemoryTest, QueueBasicsAndLimits) {
+    std::string name = shared_test_name("queue");
+    SharedQueue<int> producer(name, SharedMemoryMode::Create, 4);
+    SharedQueue<int> consumer(name, SharedMemoryMode::Open);
+
+    EXPECT_EQ(consumer.capacity(), 4);
+    EXPECT_EQ(producer.get_attached_count(), 2);
+
+    int value = 0;
+    EXPECT_FALSE(consumer.try_pop(value));
+    EXPECT_FALSE(consumer.pop_for(value, std::chrono::milliseconds(10)));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(producer.try_push(i));
+    }
+    EXPECT_FALSE(producer.try_push(4));
+    EXPECT_FALSE(producer.push_for(4, std::chrono::milliseconds(10)));
+    EXPECT_EQ(consumer.size(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        consumer.pop(value);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(consumer.empty());
+
+    // Тип элемента сверяется при подключении
+    EXPECT_THROW(SharedQueue<double>(name, SharedMemoryMode::Open), std::invalid_argument);
+    EXPECT_THROW(SharedQueue<int>(name + "_missing", SharedMemoryMode::Open), std::runtime_error);
+    EXPECT_EQ(producer.get_attached_count(), 2);
+}
+
+// Тест: передача между процессами с сохранением порядка (очередь меньше потока данных)
+TEST(SharedMemoryTest, QueueAcrossProcesses) {
+    struct Message {
+        int sequence;
+        double payload;
+    };
+    constexpr int kCount = 10000;
+    std::string name = shared_test_name("fork");
+    SharedQueue<Message> queue(name, SharedMemoryMode::Create, 16);
+
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) {
+        {
+            SharedQueue<Message> producer(name, SharedMemoryMode::Open);
+            for (int i = 0; i < kCount; ++i) {
+                producer.push(Message{i, i * 0.5});
+            }
+        }
+        _exit(0);
+    }
+
+    bool ordered = true;
+    for (int i = 0; i < kCount; ++i) {
+        Message message{};
+        queue.pop(message);
+        ordered = ordered && message.sequence == i && message.payload == i * 0.5;
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(queue.get_attached_count(), 1);
+}
+
+// Тест: производитель убивается в произвольный момент, очередь остаётся согласованной
+TEST(SharedMemoryTest, QueueSurvivesKilledProducer) {
+    constexpr size_t kCapacity = 8;
+    std::string name = shared_test_name("kill");
+    SharedQueue<int> queue(name, SharedMemoryMode::Create, kCapacity);
+
+    for (int round = 0; round < 20; ++round) {
+        pid_t child = fork();
+        ASSERT_NE(child, -1);
+        if (child == 0) {
+            SharedQueue<int> producer(name, SharedMemoryMode::Open);
+            for (int i = 0;; ++i) {
+                producer.push(i);
+            }
+        }
+
+        // Забираем часть элементов, пока производитель работает, и убиваем его
+        int previous = -1;
+        bool increasing = true;
+        for (int i = 0; i < 100 + round * 37; ++i) {
+            int value = 0;
+            if (queue.pop_for(value, std::chrono::milliseconds(1000))) {
+                increasing = increasing && value > previous;
+                previous = value;
+            }
+        }
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+
+        // Оставшиеся элементы идут по порядку, их число совпадает с size
+        size_t expected = queue.size();
+        size_t drained = 0;
+        int value = 0;
+        while (queue.try_pop(value)) {
+            increasing = increasing && value > previous;
+            previous = value;
+            ++drained;
+        }
+        EXPECT_TRUE(increasing);
+        EXPECT_EQ(drained, expected);
+    }
+
+    // Все узлы на месте: очередь вмещает ровно capacity элементов
+    for (size_t i = 0; i < kCapacity; ++i) {
+        EXPECT_TRUE(queue.try_push(static_cast<int>(i)));
+    }
+    EXPECT_FALSE(queue.try_push(-1));
+    EXPECT_EQ(queue.size(), kCapacity);
+}
+#endif
+
+// Тест: очередь переживает перезапуск через снимок пула - содержимое, счётчики и дальнейшая работа
+TEST(SnapshotTest, QueueRestoredFromSnapshot) {
+    std::string path = ::testing::TempDir() + "lab05_snapshot_queue.bin";
+    size_t allocated = 0;
+    size_t allocations = 0;
+    {
+        FixedMemoryResource memory(256 * 1024);
+        Queue<int> queue(&memory);
+        for (int i = 0; i < 2000; ++i) {
+            queue.push(i);
+        }
+        for (int i = 0; i < 500; ++i) {
+            queue.pop();
+        }
+        queue.save_snapshot(memory, path);
+        allocated = memory.get_allocated_count();
+        allocations = memory.stats().allocations;
+        queue.discard();
+        memory.release();
+    }
+
+    // Корень снимка - ещё один занятый блок, пока его не заберёт очередь
+    FixedMemoryResource memory = FixedMemoryResource::load_snapshot(path);
+    EXPECT_EQ(memory.get_allocated_count(), allocated + 1);
+    EXPECT_EQ(memory.stats().allocations, allocations);
+    Queue<int> queue = Queue<int>::load_snapshot(memory);
+    EXPECT_EQ(memory.get_allocated_count(), allocated);
+    ASSERT_EQ(queue.size(), 1500);
+    EXPECT_EQ(queue.front(), 500);
+    EXPECT_EQ(queue.back(), 1999);
+
+    int expected = 500;
+    bool ordered = true;
+    for (int value : queue) {
+        ordered = ordered && value == expected++;
+    }
+    EXPECT_TRUE(ordered);
+
+    // Освобождённые до снимка блоки снова в списках свободных
+    queue.push(2000);
+    EXPECT_GT(memory.stats().free_list_hits, 0);
+    queue.clear();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.take_snapshot_root(), nullptr);
+    std::remove(path.c_str());
+}
+
+// Тест: растущий пул из нескольких участков, после загрузки продолжает расти через upstream
+TEST(SnapshotTest, GrowablePoolKeepsChunks) {
+    struct Message {
+        int sequence;
+        char payload[100];
+    };
+    std::string path = ::testing::TempDir() + "lab05_snapshot_growable.bin";
+    {
+        FixedMemoryResourceOptions options;
+        options.initial_size = 4096;
+        options.upstream = std::pmr::new_delete_resource();
+        FixedMemoryResource memory(options);
+        Queue<Message> queue(&memory);
+        for (int i = 0; i < 300; ++i) {
+            queue.push(Message{i, {}});
+        }
+        EXPECT_GT(memory.get_chunk_count(), 2);
+        queue.save_snapshot(memory, path);
+        queue.discard();
+        memory.release();
+    }
+
+    CountingResource upstream;
+    {
+        FixedMemoryResource memory = FixedMemoryResource::load_snapshot(path, &upstream);
+        size_t chunks = memory.get_chunk_count();
+        Queue<Message> queue = Queue<Message>::load_snapshot(memory);
+        ASSERT_EQ(queue.size(), 300);
+        bool ordered = true;
+        int expected = 0;
+        for (const Message& message : queue) {
+            ordered = ordered && message.sequence == expected++;
+        }
+        EXPECT_TRUE(ordered);
+
+        for (int i = 300; i < 1000; ++i) {
+            queue.push(Message{i, {}});
+        }
+        EXPECT_GT(memory.get_chunk_count(), chunks);
+        EXPECT_EQ(queue.back().sequence, 999);
+        queue.clear();
+    }
+    EXPECT_GT(upstream.allocations, 0);
+    EXPECT_EQ(upstream.live_bytes, 0);
+    std::remove(path.c_str());
+}
+
+// Тест: указатели внутри элементов пересчитываются через fixup
+TEST(SnapshotTest, FixupRelocatesPointers) {
+    struct Item {
+        int* value;
+    };
+    std::string path = ::testing::TempDir() + "lab05_snapshot_fixup.bin";
+    {
+        FixedMemoryResource memory(64 * 1024);
+        Queue<Item> queue(&memory);
+        for (int i = 0; i < 50; ++i) {
+            int* value = static_cast<int*>(memory.allocate(sizeof(int), alignof(int)));
+            *value = i * 10;
+            queue.push(Item{value});
+        }
+        queue.save_snapshot(memory, path);
+        queue.discard();
+        memory.release();
+    }
+
+    FixedMemoryResource memory = FixedMemoryResource::load_snapshot(path);
+    Queue<Item> queue = Queue<Item>::load_snapshot(memory, [](Item& item, const FixedMemoryResource& pool) {
+        item.value = static_cast<int*>(pool.relocate(item.value));
+    });
+    int expected = 0;
+    while (!queue.empty()) {
+        int* value = queue.front().value;
+        EXPECT_TRUE(memory.owns(value));
+        EXPECT_EQ(*value, expected);
+        expected += 10;
+        memory.deallocate(value, sizeof(int), alignof(int));
+        queue.pop();
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    std::remove(path.c_str());
+}
+
+// Тест: повреждённый файл, чужой тип элемента и активные метки отвергаются
+TEST(SnapshotTest, InvalidSnapshotsRejected) {
+    std::string path = ::testing::TempDir() + "lab05_snapshot_invalid.bin";
+    FixedMemoryResource memory(64 * 1024);
+    Queue<int> queue(&memory);
+    for (int i = 0; i < 100; ++i) {
+        queue.push(i);
+    }
+
+    auto marker = memory.mark();
+    EXPECT_THROW(queue.save_snapshot(memory, path), std::runtime_error);
+    memory.rollback(marker);
+
+    FixedMemoryResource other(4096);
+    EXPECT_THROW(queue.save_snapshot(other, path), std::invalid_argument);
+
+    queue.save_snapshot(memory, path);
+    {
+        FixedMemoryResource loaded = FixedMemoryResource::load_snapshot(path);
+        EXPECT_THROW(Queue<long double>::load_snapshot(loaded), std::invalid_argument);
+    }
+    EXPECT_THROW(FixedMemoryResource::load_snapshot(path, std::pmr::new_delete_resource()),
+                 std::invalid_argument);
+
+    // Меняем байт в данных узлов: контрольная сумма не сходится
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(64 * 1024 + 100);
+        file.put('\x5a');
+    }
+    EXPECT_THROW(FixedMemoryResource::load_snapshot(path), std::runtime_error);
+    EXPECT_THROW(FixedMemoryResource::load_snapshot(path + ".missing"), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// Тест: ссылка узла за пределы пула - повреждённая цепочка, корень снимка не теряется
+TEST(SnapshotTest, DamagedQueueChainRejected) {
+    std::string path = ::testing::TempDir() + "lab05_snapshot_damaged.bin";
+    uint64_t outside = 0;
+    {
+        FixedMemoryResource memory(64 * 1024);
+        Queue<uint64_t> queue(&memory);
+        for (uint64_t i = 0; i < 10; ++i) {
+            queue.push(i);
+        }
+        // Поле next второго узла лежит сразу за его данными
+        uint64_t* second = &*std::next(queue.begin());
+        *reinterpret_cast<void**>(second + 1) = &outside;
+        queue.save_snapshot(memory, path);
+        queue.discard();
+        memory.release();
+    }
+
+    FixedMemoryResource memory = FixedMemoryResource::load_snapshot(path);
+    ASSERT_EQ(memory.get_allocated_count(), 11);
+    EXPECT_THROW(Queue<uint64_t>::load_snapshot(memory), std::runtime_error);
+
+    // Корень и первый (уже разобранный) узел освобождены, остальные узлы остаются занятыми
+    EXPECT_EQ(memory.take_snapshot_root(), nullptr);
+    EXPECT_EQ(memory.get_allocated_count(), 9);
+    memory.release();
+    std::remove(path.c_str());
+}
+
+// Тест: пакет выделяется подряд с вершины пула, учёт как у отдельных выделений
+TEST(BulkAllocationTest, ContiguousFromTop) {
+    FixedMemoryResource memory(64 * 1024);
+    void* blocks[100];
+    memory.allocate_bulk(blocks, 100, 40);
+
+    size_t block = FixedMemoryResource::block_size_for(40);
+    for (size_t i = 1; i < 100; ++i) {
+        EXPECT_EQ(static_cast<char*>(blocks[i]) - static_cast<char*>(blocks[i - 1]),
+                  static_cast<std::ptrdiff_t>(block));
+    }
+    EXPECT_EQ(memory.get_current_offset(), 100 * block);
+    EXPECT_EQ(memory.get_allocated_count(), 100);
+    EXPECT_EQ(memory.stats().bump_allocations, 100);
+
+    // Блоки освобождаются по одному и сливаются как обычно
+    for (size_t i = 0; i < 100; ++i) {
+        memory.deallocate(blocks[i], 40);
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: пакет, не помещающийся в остаток, собирается из свободных блоков; при нехватке - ничего не выделено
+TEST(BulkAllocationTest, FallbackAndAllOrNothing) {
+    // 60 блоков пакета, барьер и ещё один блок в остатке
+    FixedMemoryResource memory(62 * FixedMemoryResource::block_size_for(48));
+    void* blocks[64];
+    memory.allocate_bulk(blocks, 60, 48);
+    void* barrier = memory.allocate(48);
+    for (size_t i = 0; i < 60; i += 2) {
+        memory.deallocate(blocks[i], 48);
+    }
+
+    // 30 свободных блоков вразброс, остатка пула на пакет не хватает
+    size_t offset = memory.get_current_offset();
+    void* reused[30];
+    memory.allocate_bulk(reused, 30, 48);
+    EXPECT_EQ(memory.get_current_offset(), offset);
+    EXPECT_EQ(memory.get_free_count(), 0);
+
+    size_t allocated = memory.get_allocated_count();
+    void* failed[64];
+    EXPECT_THROW(memory.allocate_bulk(failed, 64, 48), std::bad_alloc);
+    EXPECT_EQ(memory.get_allocated_count(), allocated);
+    EXPECT_EQ(memory.get_current_offset(), offset);
+
+    for (void* ptr : reused) {
+        memory.deallocate(ptr, 48);
+    }
+    for (size_t i = 1; i < 60; i += 2) {
+        memory.deallocate(blocks[i], 48);
+    }
+    memory.deallocate(barrier, 48);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: растущий пул подключает участок под весь пакет
+TEST(BulkAllocationTest, GrowablePoolAddsChunkForBatch) {
+    FixedMemoryResourceOptions options;
+    options.initial_size = 4096;
+    options.upstream = std::pmr::new_delete_resource();
+    FixedMemoryResource memory(options);
+
+    std::vector<void*> blocks(500);
+    memory.allocate_bulk(blocks.data(), blocks.size(), 24);
+    EXPECT_EQ(memory.get_chunk_count(), 2);
+    size_t block = FixedMemoryResource::block_size_for(24);
+    EXPECT_EQ(static_cast<char*>(blocks.back()) - static_cast<char*>(blocks.front()),
+              static_cast<std::ptrdiff_t>(499 * block));
+    for (void* ptr : blocks) {
+        memory.deallocate(ptr, 24);
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: push_range кладёт узлы подряд и сохраняет порядок; с другим ресурсом работает как push
+TEST(BulkAllocationTest, QueuePushRange) {
+    std::vector<int> values(1000);
+    for (int i = 0; i < 1000; ++i) {
+        values[i] = i;
+    }
+
+    FixedMemoryResource memory(256 * 1024);
+    QueueMetrics metrics;
+    Queue<int> queue(&memory);
+    queue.set_metrics(&metrics);
+    queue.push(-1);
+    queue.push_range(values.begin(), values.end());
+    ASSERT_EQ(queue.size(), 1001);
+    EXPECT_EQ(metrics.pushes, 1001);
+    EXPECT_EQ(metrics.depth, 1001);
+    EXPECT_EQ(memory.get_allocated_count(), 1001);
+
+    size_t block = FixedMemoryResource::block_size_for(Queue<int>::node_size);
+    const int* previous = nullptr;
+    int expected = -1;
+    bool ordered = true;
+    bool sequential = true;
+    for (const int& value : queue) {
+        ordered = ordered && value == expected++;
+        if (previous) {
+            sequential = sequential && reinterpret_cast<const char*>(&value) -
+                                           reinterpret_cast<const char*>(previous) ==
+                                           static_cast<std::ptrdiff_t>(block);
+        }
+        previous = &value;
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(sequential);
+    queue.clear();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+
+    CountingResource counting;
+    Queue<int> other(&counting);
+    other.push_range(values.begin(), values.end());
+    EXPECT_EQ(other.size(), 1000);
+    EXPECT_EQ(counting.allocations, 1000);
+}
+
+// Тест: пакетный путь определяется при создании очереди и переходит к перемещённой очереди;
+// ресурс, производный от FixedMemoryResource, тоже выделяет пакетами
+TEST(BulkAllocationTest, PushRangeResolvedAtConstruction) {
+    std::vector<int> values(300, 7);
+    InlineFixedMemoryResource<64 * 1024> memory;
+    Queue<int> source(&memory);
+    Queue<int> queue(std::move(source));
+    queue.push_range(values.begin(), values.end());
+    EXPECT_EQ(memory.stats().bump_allocations, 300);
+    EXPECT_EQ(memory.get_current_offset(),
+              300 * FixedMemoryResource::block_size_for(Queue<int>::node_size));
+    queue.clear();
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+}
+
+// Тест: исключение из конструктора элемента посреди пакета - добавленные остаются, остальные узлы возвращены
+TEST(BulkAllocationTest, PushRangeThrowingElement) {
+    struct Fragile {
+        int value;
+        explicit Fragile(int v) : value(v) {}
+        Fragile(const Fragile& other) : value(other.value) {
+            if (value == 77) {
+                throw std::runtime_error("copy failed");
+            }
+        }
+    };
+    std::vector<Fragile> values;
+    for (int i = 0; i < 100; ++i) {
+        values.emplace_back(i);
+    }
+
+    FixedMemoryResource memory(64 * 1024);
+    Queue<Fragile> queue(&memory);
+    EXPECT_THROW(queue.push_range(values.begin(), values.end()), std::runtime_error);
+    EXPECT_EQ(queue.size(), 77);
+    EXPECT_EQ(queue.back().value, 76);
+    EXPECT_EQ(memory.get_allocated_count(), 77);
+    queue.clear();
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: блок у вершины растёт и сжимается сдвигом вершины, данные остаются на месте
+TEST(InPlaceResizeTest, ExpandAndShrinkAtTop) {
+    FixedMemoryResource memory(64 * 1024);
+    auto* data = static_cast<char*>(memory.allocate(40));
+    std::fill(data, data + 40, 'x');
+
+    EXPECT_TRUE(memory.try_expand(data, 40, 400));
+    EXPECT_EQ(memory.get_current_offset(), FixedMemoryResource::block_size_for(400));
+    EXPECT_EQ(memory.stats().bytes_in_use, FixedMemoryResource::block_size_for(400));
+    EXPECT_TRUE(std::all_of(data, data + 40, [](char c) { return c == 'x'; }));
+    std::fill(data, data + 400, 'y');
+
+    memory.shrink(data, 400, 40);
+    EXPECT_EQ(memory.get_current_offset(), FixedMemoryResource::block_size_for(40));
+    EXPECT_EQ(memory.get_free_count(), 0);
+    EXPECT_TRUE(std::all_of(data, data + 40, [](char c) { return c == 'y'; }));
+
+    // Больше пула не вырасти: блок и вершина не меняются
+    EXPECT_FALSE(memory.try_expand(data, 40, 64 * 1024));
+    EXPECT_EQ(memory.get_current_offset(), FixedMemoryResource::block_size_for(40));
+    EXPECT_THROW(memory.shrink(data, 40, 41), std::invalid_argument);
+
+    memory.deallocate(data, 40);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+    EXPECT_EQ(memory.stats().bytes_in_use, 0);
+}
+
+// Тест: рост за счёт свободного соседа справа, остаток соседа остаётся свободным
+TEST(InPlaceResizeTest, ExpandIntoFreeNeighbour) {
+    FixedMemoryResource memory(64 * 1024);
+    void* first = memory.allocate(64);
+    void* neighbour = memory.allocate(256);
+    void* barrier = memory.allocate(64);
+    memory.deallocate(neighbour, 256);
+    size_t offset = memory.get_current_offset();
+
+    EXPECT_TRUE(memory.try_expand(first, 64, 128));
+    EXPECT_EQ(memory.get_free_count(), 1);
+    EXPECT_EQ(memory.get_current_offset(), offset);
+
+    // Соседа не хватает, а блок не у вершины
+    EXPECT_FALSE(memory.try_expand(first, 128, 1024));
+    EXPECT_EQ(memory.get_free_count(), 1);
+
+    // Сосед поглощается целиком
+    size_t whole = FixedMemoryResource::block_size_for(64) + FixedMemoryResource::block_size_for(256);
+    EXPECT_TRUE(memory.try_expand(first, 128, whole - FixedMemoryResource::block_size_for(0)));
+    EXPECT_EQ(memory.get_free_count(), 0);
+
+    memory.deallocate(first, whole - FixedMemoryResource::block_size_for(0));
+    memory.deallocate(barrier, 64);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+    EXPECT_EQ(memory.get_free_count(), 0);
+}
+
+// Тест: хвост сжатого блока уходит в списки свободных и снова поглощается при росте
+TEST(InPlaceResizeTest, ShrinkReturnsTailToFreeList) {
+    FixedMemoryResource memory(64 * 1024);
+    void* block = memory.allocate(1024);
+    void* barrier = memory.allocate(64);
+    size_t free_before = memory.get_free_bytes();
+
+    memory.shrink(block, 1024, 100);
+    EXPECT_EQ(memory.get_free_count(), 1);
+    EXPECT_EQ(memory.get_free_bytes(), free_before + FixedMemoryResource::block_size_for(1024) -
+                                           FixedMemoryResource::block_size_for(100));
+
+    // Хвост слишком мал для отдельного блока - размер блока не меняется
+    memory.shrink(block, 100, 96);
+    EXPECT_EQ(memory.get_free_count(), 1);
+
+    EXPECT_TRUE(memory.try_expand(block, 96, 1024));
+    EXPECT_EQ(memory.get_free_count(), 0);
+    EXPECT_EQ(memory.get_free_bytes(), free_before);
+
+    memory.deallocate(block, 1024);
+    memory.deallocate(barrier, 64);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: блок, выделенный до метки, не растёт, пока метка активна
+TEST(InPlaceResizeTest, MarkerBlocksExpansion) {
+    FixedMemoryResource memory(64 * 1024);
+    void* block = memory.allocate(40);
+    auto marker = memory.mark();
+    EXPECT_FALSE(memory.try_expand(block, 40, 400));
+    memory.shrink(block, 40, 8);
+    void* inner = memory.allocate(40);
+    EXPECT_TRUE(memory.try_expand(inner, 40, 400));
+    memory.rollback(marker);
+
+    EXPECT_TRUE(memory.try_expand(block, 8, 400));
+    memory.deallocate(block, 400);
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+// Тест: буфер у вершины растёт без копирования, при занятом соседе - с переносом
+TEST(InPlaceResizeTest, GrowableBuffer) {
+    FixedMemoryResource memory(256 * 1024);
+    {
+        GrowableBuffer buffer(memory);
+        for (int i = 0; i < 1000; ++i) {
+            buffer.append(&i, sizeof(i));
+        }
+        const char* data = buffer.data();
+        EXPECT_EQ(buffer.size(), 1000 * sizeof(int));
+        EXPECT_EQ(buffer.get_relocation_count(), 0);
+
+        // Вершину занял другой блок - дальше только с переносом
+        void* blocker = memory.allocate(16);
+        buffer.resize(buffer.capacity() + 64);
+        EXPECT_EQ(buffer.get_relocation_count(), 1);
+        EXPECT_NE(buffer.data(), data);
+        EXPECT_EQ(buffer.data()[buffer.size() - 1], 0);
+        buffer.resize(1000 * sizeof(int));
+
+        bool intact = true;
+        for (int i = 0; i < 1000; ++i) {
+            int value;
+            std::memcpy(&value, buffer.data() + i * sizeof(int), sizeof(int));
+            intact = intact && value == i;
+        }
+        EXPECT_TRUE(intact);
+
+        buffer.shrink_to_fit();
+        EXPECT_EQ(buffer.capacity(), buffer.size());
+        GrowableBuffer moved(std::move(buffer));
+        EXPECT_EQ(buffer.data(), nullptr);
+        EXPECT_EQ(moved.size(), 1000 * sizeof(int));
+        memory.deallocate(blocker, 16);
+    }
+    EXPECT_EQ(memory.get_allocated_count(), 0);
+    EXPECT_EQ(memory.get_current_offset(), 0);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
 }
\ No newline at end of file